@@ -0,0 +1,94 @@
+#pragma once
+
+// Shared helpers for the vectkit benchmarks. Build with -DVECTKIT_BUILD_BENCHMARKS=ON and
+// -DCMAKE_BUILD_TYPE=Release; numbers from unoptimised builds are meaningless.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <string>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace bench {
+
+    // Best wall-clock time of `reps` runs, in seconds
+    template <typename F> double best_of(int reps, F &&fn) {
+        double best = std::numeric_limits<double>::max();
+        for (int i = 0; i < reps; ++i) {
+            auto t0 = std::chrono::steady_clock::now();
+            fn();
+            auto t1 = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+        }
+        return best;
+    }
+
+    // Runs fn in a forked child and returns the child's peak RSS in KiB, so every variant starts from
+    // the same baseline and one variant's high-water mark does not hide another's
+    template <typename F> long peak_rss_kib(F &&fn) {
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            fn();
+            ::_exit(0);
+        }
+        int status = 0;
+        struct rusage ru {};
+        ::wait4(pid, &status, 0, &ru);
+        return ru.ru_maxrss;
+    }
+
+    // Writes a synthetic WGS FeatureCollection of roughly `target_bytes` made of dense polygons, the
+    // shape of a field archive export
+    inline std::filesystem::path make_collection(size_t target_bytes, size_t points_per_polygon = 256) {
+        auto name = "vectkit_bench_" + std::to_string(target_bytes) + "_" + std::to_string(points_per_polygon);
+        name += ".geojson";
+        auto path = std::filesystem::temp_directory_path() / name;
+        if (std::filesystem::exists(path) && std::filesystem::file_size(path) >= target_bytes)
+            return path;
+
+        std::ofstream ofs(path);
+        ofs << std::setprecision(15);
+        ofs << R"({"type":"FeatureCollection","properties":{"crs":"EPSG:4326","datum":[5.66,51.98,0.0],"heading":0.0},)"
+            << "\n" << R"("features":[)" << "\n";
+
+        size_t id = 0;
+        while (static_cast<size_t>(ofs.tellp()) < target_bytes) {
+            if (id > 0)
+                ofs << ",\n";
+            double cx = 5.66 + 0.0001 * static_cast<double>(id % 1000);
+            double cy = 51.98 + 0.0001 * static_cast<double>(id / 1000);
+            ofs << R"({"type":"Feature","properties":{"type":"obstacle","id":)" << id
+                << R"(,"uuid":"00000000-0000-0000-0000-)" << std::setw(12) << std::setfill('0') << id
+                << std::setfill(' ')
+                << R"("},"geometry":{"type":"Polygon","coordinates":[[)";
+            for (size_t i = 0; i <= points_per_polygon; ++i) {
+                double a = 2.0 * M_PI * static_cast<double>(i % points_per_polygon) /
+                           static_cast<double>(points_per_polygon);
+                if (i > 0)
+                    ofs << ",";
+                ofs << "[" << cx + 0.00004 * std::cos(a) << "," << cy + 0.00003 * std::sin(a) << "]";
+            }
+            ofs << "]]}}";
+            ++id;
+        }
+        ofs << "\n]}\n";
+        return path;
+    }
+
+    inline void report(const char *name, double seconds, size_t bytes, long rss_kib = -1) {
+        std::printf("  %-28s %9.2f ms  %8.1f MB/s", name, seconds * 1e3, static_cast<double>(bytes) / seconds / 1e6);
+        if (rss_kib >= 0)
+            std::printf("  peak RSS %8.1f MiB", static_cast<double>(rss_kib) / 1024.0);
+        std::printf("\n");
+    }
+
+} // namespace bench
@@ -0,0 +1,68 @@
+// Coordinate parsing throughput: the previous std::stod(std::string(...)) conversion against the
+// allocation-free detail::scan::parse_number, over every number literal of misc/wur.geojson repeated
+// until a few million values are queued.
+//
+//   bench_number [min_values=4000000] [reps=5]
+
+#include "bench.hpp"
+#include "vectkit/io.hpp"
+#include "vectkit/scan.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+int main(int argc, char **argv) {
+    size_t min_values = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4000000;
+    int reps = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    vectkit::detail::MappedFile input(PROJECT_DIR "/misc/wur.geojson");
+    if (!input.is_open()) {
+        std::fprintf(stderr, "cannot open misc/wur.geojson\n");
+        return 1;
+    }
+
+    // Collect the raw text of every number literal, outside of strings
+    std::vector<std::string_view> literals;
+    const char *p = input.data();
+    const char *end = p + input.size();
+    while (p < end) {
+        if (*p == '"') {
+            p = vectkit::detail::scan::skip_string(p, end);
+        } else if (*p == '-' || (*p >= '0' && *p <= '9')) {
+            const char *start = p;
+            while (p < end && vectkit::detail::scan::is_number_char(*p))
+                ++p;
+            literals.emplace_back(start, static_cast<size_t>(p - start));
+        } else {
+            ++p;
+        }
+    }
+
+    std::vector<std::string_view> values;
+    while (values.size() < min_values)
+        values.insert(values.end(), literals.begin(), literals.end());
+    std::printf("%zu literals in wur.geojson, %zu values queued\n", literals.size(), values.size());
+
+    double sink = 0.0;
+    double t_stod = bench::best_of(reps, [&] {
+        for (auto v : values)
+            sink += std::stod(std::string(v));
+    });
+    double t_fast = bench::best_of(reps, [&] {
+        for (auto v : values)
+            sink += vectkit::detail::scan::parse_number(v.data(), v.size());
+    });
+
+    size_t mismatches = 0;
+    for (auto v : literals)
+        mismatches += std::stod(std::string(v)) != vectkit::detail::scan::parse_number(v.data(), v.size());
+
+    auto rate = [&](double t) { return static_cast<double>(values.size()) / t / 1e6; };
+    std::printf("  %-22s %8.2f ms  %7.1f M values/s  %6.1f ns/value\n", "std::stod(std::string)", t_stod * 1e3,
+                rate(t_stod), t_stod * 1e9 / static_cast<double>(values.size()));
+    std::printf("  %-22s %8.2f ms  %7.1f M values/s  %6.1f ns/value\n", "scan::parse_number", t_fast * 1e3,
+                rate(t_fast), t_fast * 1e9 / static_cast<double>(values.size()));
+    std::printf("speedup %.2fx, %zu mismatching values (checksum %g)\n", t_stod / t_fast, mismatches, sink);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+// Load time and peak memory of reading a large FeatureCollection: the previous
+// ifstream -> stringstream -> std::string -> json_parse path against parsing straight from the
+// mapped file, and building the generic DOM against decoding features directly (vectkit::read
+// does the latter and still ends up with the full FeatureCollection), serially and on a thread pool,
+// and what a property filter that rejects every feature or a small query region leave of that.
+//
+//   bench_read [size_mb=256] [reps=3] [threads=0 (all cores)]
+
+#include "bench.hpp"
+#include "vectkit/vectkit.hpp"
+
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+    // The pre-mmap input path, kept here as the reference point
+    vectkit::detail::JsonPtr parse_copied(const std::filesystem::path &file) {
+        std::ifstream ifs(file);
+        std::stringstream buffer;
+        buffer << ifs.rdbuf();
+        std::string content = buffer.str();
+        return vectkit::detail::JsonPtr(json_parse(content.c_str(), content.size()));
+    }
+
+    vectkit::detail::JsonPtr parse_mapped(const std::filesystem::path &file) {
+        vectkit::detail::MappedFile input(file);
+        return vectkit::detail::JsonPtr(json_parse(input.data(), input.size()));
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t size_mb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+    int reps = argc > 2 ? std::atoi(argv[2]) : 3;
+    size_t threads = vectkit::detail::resolve_threads(argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 0);
+
+    auto file = bench::make_collection(size_mb << 20);
+    size_t bytes = std::filesystem::file_size(file);
+    std::printf("input: %s (%.1f MiB)\n", file.c_str(), static_cast<double>(bytes) / (1 << 20));
+
+    std::printf("file -> DOM\n");
+    double t_copy = bench::best_of(reps, [&] { parse_copied(file); });
+    long rss_copy = bench::peak_rss_kib([&] { parse_copied(file); });
+    bench::report("copied (ifstream)", t_copy, bytes, rss_copy);
+
+    double t_map = bench::best_of(reps, [&] { parse_mapped(file); });
+    long rss_map = bench::peak_rss_kib([&] { parse_mapped(file); });
+    bench::report("mapped", t_map, bytes, rss_map);
+
+    std::printf("file -> FeatureCollection\n");
+    double t_read = bench::best_of(reps, [&] { vectkit::read(file); });
+    long rss_read = bench::peak_rss_kib([&] { vectkit::read(file); });
+    bench::report("vectkit::read", t_read, bytes, rss_read);
+
+    vectkit::ReadOptions options{.threads = threads};
+    double t_par = bench::best_of(reps, [&] { vectkit::read(file, options); });
+    long rss_par = bench::peak_rss_kib([&] { vectkit::read(file, options); });
+    char label[64];
+    std::snprintf(label, sizeof(label), "vectkit::read (%zu threads)", threads);
+    bench::report(label, t_par, bytes, rss_par);
+
+    // Loading one layer that matches nothing: the cost of the features a filter rejects
+    vectkit::ReadOptions none;
+    none.filter = [](const auto &properties) { return properties.at("type") == "field"; };
+    double t_none = bench::best_of(reps, [&] { vectkit::read(file, none); });
+    bench::report("vectkit::read (all filtered)", t_none, bytes);
+
+    // A region a tenth of the collection's width and height (features are laid out on a 1000-wide grid)
+    vectkit::ReadOptions nearby;
+    nearby.region = vectkit::Region::box(vectkit::CRS::WGS, 5.66, 51.98, 5.67, 51.98 + 0.00001 * bytes / (1 << 20));
+    size_t kept = vectkit::read(file, nearby).features.size();
+    double t_region = bench::best_of(reps, [&] { vectkit::read(file, nearby); });
+    bench::report("vectkit::read (region)", t_region, bytes);
+
+    // Properties kept as raw text until used; nothing here touches them
+    vectkit::ReadOptions lazy;
+    lazy.lazy_properties = true;
+    double t_lazy = bench::best_of(reps, [&] { vectkit::read(file, lazy); });
+    bench::report("vectkit::read (lazy props)", t_lazy, bytes);
+
+    std::printf("mapped: speedup %.2fx, peak memory %.0f%% of copied path\n", t_copy / t_map,
+                100.0 * static_cast<double>(rss_map) / static_cast<double>(rss_copy));
+    std::printf("direct decode: %.2fx faster than building the DOM alone, peak memory %.0f%% of it\n",
+                t_map / t_read, 100.0 * static_cast<double>(rss_read) / static_cast<double>(rss_map));
+    std::printf("threads: %.2fx over the serial read\n", t_read / t_par);
+    std::printf("filter: rejected features cost %.0f%% of a full read\n", 100.0 * t_none / t_read);
+    std::printf("region: %zu features kept in %.0f%% of a full read\n", kept, 100.0 * t_region / t_read);
+    std::printf("lazy properties: %.0f%% of a full read\n", 100.0 * t_lazy / t_read);
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Throughput of the structural scanner that every read runs on: validating a whole document with
+// scan::skip_value (quotes, escapes, whitespace and number tokens, nothing decoded), and the full
+// vectkit::read on top of it. Both are measured on a compact file and on the same data indented
+// like a hand-edited export, where whitespace runs dominate. Build once as is and once with
+// -DVECTKIT_ENABLE_SIMD=OFF to compare the AVX2 and scalar scanners.
+//
+//   bench_scan [size_mb=256] [reps=5]
+
+#include "bench.hpp"
+#include "vectkit/vectkit.hpp"
+
+#include <fstream>
+
+namespace {
+
+    // Re-indents a JSON file, 4 spaces per level, one value per line
+    std::filesystem::path make_indented(const std::filesystem::path &compact) {
+        auto path = compact;
+        path.replace_extension(".indented.geojson");
+        if (std::filesystem::exists(path))
+            return path;
+
+        vectkit::detail::MappedFile in(compact);
+        std::ofstream out(path);
+        std::string line;
+        size_t depth = 0;
+        bool in_string = false;
+        auto newline = [&] {
+            out << line << '\n';
+            line.assign(depth * 4, ' ');
+        };
+        for (size_t i = 0; i < in.size(); ++i) {
+            char c = in.data()[i];
+            if (in_string) {
+                line += c;
+                if (c == '\\')
+                    line += in.data()[++i];
+                else if (c == '"')
+                    in_string = false;
+                continue;
+            }
+            switch (c) {
+            case '"':
+                in_string = true;
+                line += c;
+                break;
+            case '{':
+            case '[':
+                line += c;
+                ++depth;
+                newline();
+                break;
+            case '}':
+            case ']':
+                --depth;
+                newline();
+                line += c;
+                break;
+            case ',':
+                line += c;
+                newline();
+                break;
+            case ':':
+                line += ": ";
+                break;
+            case ' ':
+            case '\n':
+            case '\r':
+            case '\t':
+                break;
+            default:
+                line += c;
+            }
+        }
+        out << line << '\n';
+        return path;
+    }
+
+    void run(const char *title, const std::filesystem::path &file, int reps) {
+        vectkit::detail::MappedFile input(file);
+        size_t bytes = input.size();
+        std::printf("%s: %s (%.1f MiB)\n", title, file.c_str(), static_cast<double>(bytes) / (1 << 20));
+
+        double t_scan = bench::best_of(reps, [&] {
+            const char *end = input.data() + bytes;
+            const char *p = vectkit::detail::scan::skip_ws(input.data(), end);
+            if (vectkit::detail::scan::skip_value(p, end) == nullptr)
+                std::abort();
+        });
+        bench::report("scan::skip_value", t_scan, bytes);
+
+        double t_read = bench::best_of(reps, [&] { vectkit::read_from_buffer(input.view()); });
+        bench::report("vectkit::read_from_buffer", t_read, bytes);
+        std::printf("  structural scan: %.2f GB/s\n", static_cast<double>(bytes) / t_scan / 1e9);
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t size_mb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+    int reps = argc > 2 ? std::atoi(argv[2]) : 5;
+
+#ifdef VECTKIT_SCAN_AVX2
+    std::printf("scanner: AVX2, 32 bytes per block\n");
+#else
+    std::printf("scanner: scalar\n");
+#endif
+    auto compact = bench::make_collection(size_mb << 20);
+    run("compact", compact, reps);
+    run("indented", make_indented(compact), reps);
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Writer throughput in coordinates per second: the previous snprintf("%.15g") number formatting
+// against the shortest round-trip std::to_chars form the writer uses now, then whole collections
+// serialized with write_to_buffer in ENU (no conversion) and WGS output, and WGS output to a buffer and
+// to a file on 1, 2, 4 and all hardware threads. Last, fixed decimal places against exact output: text
+// size, write time and the time to read the text back.
+//
+//   bench_write [size_mib=64] [reps=5]
+
+#include "bench.hpp"
+#include "vectkit/vectkit.hpp"
+
+#include <cstdio>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+    // The writer's number formatting before shortest round-trip output
+    void append_number_15g(std::string &out, double v) {
+        char buf[32];
+        int n = std::snprintf(buf, sizeof(buf), "%.15g", v);
+        out.append(buf, static_cast<size_t>(n));
+    }
+
+    size_t count_points(const vectkit::FeatureCollection &fc) {
+        size_t n = 0;
+        for (const auto &f : fc.features) {
+            if (const auto *poly = std::get_if<dp::Polygon>(&f.geometry))
+                n += poly->vertices.size();
+        }
+        return n;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t mib = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    int reps = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    auto path = bench::make_collection(mib << 20);
+    auto fc = vectkit::read(path);
+    size_t points = count_points(fc);
+    std::printf("%zu features, %zu points\n", fc.features.size(), points);
+
+    // Every ENU coordinate, three numbers per point
+    std::vector<double> values;
+    values.reserve(points * 3);
+    for (const auto &f : fc.features) {
+        if (const auto *poly = std::get_if<dp::Polygon>(&f.geometry)) {
+            for (const auto &p : poly->vertices)
+                values.insert(values.end(), {p.x, p.y, p.z});
+        }
+    }
+
+    std::string out;
+    out.reserve(values.size() * 24);
+    double t_old = bench::best_of(reps, [&] {
+        out.clear();
+        for (double v : values) {
+            append_number_15g(out, v);
+            out += ',';
+        }
+    });
+    size_t old_bytes = out.size();
+    double t_new = bench::best_of(reps, [&] {
+        out.clear();
+        for (double v : values) {
+            vectkit::detail::append_number(out, v);
+            out += ',';
+        }
+    });
+
+    // Numbers the old form does not read back exactly
+    size_t lossy = 0;
+    for (double v : values) {
+        std::string text;
+        append_number_15g(text, v);
+        lossy += std::strtod(text.c_str(), nullptr) != v;
+    }
+
+    auto coord_rate = [&](double t, size_t coords) { return static_cast<double>(coords) / t / 1e6; };
+    std::printf("number formatting, %zu values\n", values.size());
+    std::printf("  %-22s %8.2f ms  %7.1f M coords/s  %6.1f MB out\n", "snprintf %.15g", t_old * 1e3,
+                coord_rate(t_old, values.size() / 3), static_cast<double>(old_bytes) / 1e6);
+    std::printf("  %-22s %8.2f ms  %7.1f M coords/s  %6.1f MB out\n", "std::to_chars shortest", t_new * 1e3,
+                coord_rate(t_new, values.size() / 3), static_cast<double>(out.size()) / 1e6);
+    std::printf("speedup %.2fx, %zu of %zu values lossy at 15 digits\n", t_old / t_new, lossy, values.size());
+
+    std::printf("whole collection, write_to_buffer\n");
+    for (auto crs : {vectkit::CRS::ENU, vectkit::CRS::WGS}) {
+        std::string doc;
+        double t = bench::best_of(reps, [&] { vectkit::write_to_buffer(fc, doc, crs); });
+        std::printf("  %-22s %8.2f ms  %7.1f M coords/s  %7.1f MB/s\n", crs == vectkit::CRS::ENU ? "ENU" : "WGS",
+                    t * 1e3, coord_rate(t, points), static_cast<double>(doc.size()) / t / 1e6);
+    }
+
+    // WGS output converts every point, which dominates the serial writer
+    std::printf("threaded WGS write\n");
+    auto out_path = std::filesystem::temp_directory_path() / "vectkit_bench_write.geojson";
+    for (size_t threads : {size_t(1), size_t(2), size_t(4), size_t(0)}) {
+        vectkit::WriteOptions options{.crs = vectkit::CRS::WGS, .threads = threads};
+        std::string doc;
+        double t_buf = bench::best_of(reps, [&] { vectkit::write_to_buffer(fc, doc, options); });
+        double t_file = bench::best_of(reps, [&] { vectkit::write(fc, out_path, options); });
+        char name[32];
+        std::snprintf(name, sizeof(name), "threads=%zu", vectkit::detail::resolve_threads(threads));
+        std::printf("  %-22s buffer %8.2f ms  %7.1f M coords/s   file %8.2f ms  %7.1f M coords/s\n", name,
+                    t_buf * 1e3, coord_rate(t_buf, points), t_file * 1e3, coord_rate(t_file, points));
+    }
+    std::filesystem::remove(out_path);
+
+    // Fixed decimal places against shortest round-trip output: size, write and re-read time
+    std::printf("quantized output\n");
+    struct Variant {
+        const char *name;
+        vectkit::WriteOptions options;
+    };
+    for (const Variant &v : {Variant{"ENU exact", {.crs = vectkit::CRS::ENU}},
+                             Variant{"ENU 3 decimals", {.crs = vectkit::CRS::ENU, .enu_decimals = 3}},
+                             Variant{"WGS exact", {.crs = vectkit::CRS::WGS}},
+                             Variant{"WGS 8 decimals", {.crs = vectkit::CRS::WGS, .wgs_decimals = 8}}}) {
+        std::string doc;
+        double t_write = bench::best_of(reps, [&] { vectkit::write_to_buffer(fc, doc, v.options); });
+        double t_read = bench::best_of(reps, [&] { vectkit::read_from_buffer(doc); });
+        std::printf("  %-22s %7.1f MB  write %8.2f ms  %7.1f M coords/s   read %8.2f ms\n", v.name,
+                    static_cast<double>(doc.size()) / 1e6, t_write * 1e3, coord_rate(t_write, points), t_read * 1e3);
+    }
+    return 0;
+}
@@ -1,10 +1,12 @@
 #pragma once
 
 #include "json.hpp"
+#include "vectkit/scan.hpp"
 #include <concord/concord.hpp>
 #include <datapod/datapod.hpp>
 
 #include <arpa/inet.h>
+#include <cmath>
 #include <condition_variable>
 #include <cstdlib>
 #include <cstring>
@@ -13,6 +15,7 @@
 #include <mutex>
 #include <netinet/in.h>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <sys/socket.h>
 #include <thread>
@@ -52,12 +55,18 @@ namespace geoget {
             return nullptr;
         }
 
-        // Helper to get a number value from a JSON value
+        // Helper to get a number value from a JSON value (locale-independent, no temporary string). Parsed
+        // like vectkit's coordinates; a literal outside the double range throws, as std::stod did, so the
+        // request is rejected instead of storing an infinite coordinate.
         inline double get_number(json_value_s *val) {
             if (!val || val->type != json_type_number)
                 return 0.0;
             auto *num = static_cast<json_number_s *>(val->payload);
-            return std::stod(std::string(num->number, num->number_size));
+            double v = vectkit::detail::scan::parse_number(num->number, num->number_size);
+            if (!std::isfinite(v))
+                throw std::out_of_range("geoget: number out of range: " +
+                                        std::string(num->number, num->number_size));
+            return v;
         }
 
         // Helper to build a simple JSON response string
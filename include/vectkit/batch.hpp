@@ -0,0 +1,116 @@
+#pragma once
+
+#include "vectkit/parser.hpp"
+#include "vectkit/pool.hpp"
+#include "vectkit/types.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace vectkit {
+
+    // One file of a batch read: its collection, or why it could not be read
+    struct FileResult {
+        std::filesystem::path path;
+        FeatureCollection collection; // empty when the read failed
+        std::string error;            // empty when the read succeeded
+
+        bool ok() const { return error.empty(); }
+        explicit operator bool() const { return ok(); }
+    };
+
+    struct BatchOptions {
+        // Files read at once (0 = one per hardware thread). Each reading thread keeps its own
+        // ParseContext, so buffers are reused from one file to the next.
+        size_t threads = 0;
+
+        // Applied to every file. Its 'threads' splits a single file and multiplies with the above, so
+        // leave it at 1 unless the batch holds a few very large files.
+        ReadOptions read{};
+    };
+
+    namespace detail {
+        // Matches a file name against a pattern where '*' is any run of characters and '?' any one
+        inline bool wildcard_match(std::string_view name, std::string_view pattern) {
+            size_t n = 0, p = 0;
+            size_t star = std::string_view::npos, resume = 0;
+            while (n < name.size()) {
+                if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+                    ++n;
+                    ++p;
+                } else if (p < pattern.size() && pattern[p] == '*') {
+                    star = p++;
+                    resume = n;
+                } else if (star != std::string_view::npos) {
+                    p = star + 1;
+                    n = ++resume;
+                } else {
+                    return false;
+                }
+            }
+            while (p < pattern.size() && pattern[p] == '*')
+                ++p;
+            return p == pattern.size();
+        }
+    } // namespace detail
+
+    // Reads every file on up to options.threads threads. Results come back in the order of 'files'; a
+    // file that cannot be opened or parsed gets its error message and does not stop the others.
+    inline std::vector<FileResult> ReadFeatureCollections(std::span<const std::filesystem::path> files,
+                                                          const BatchOptions &options = {}) {
+        std::vector<FileResult> results(files.size());
+        std::atomic<size_t> next{0};
+        size_t workers = std::min(detail::resolve_threads(options.threads), files.size());
+        // One task per worker, each pulling files in order, so a worker's context serves all its files
+        detail::parallel_for(workers, workers, [&](size_t) {
+            ParseContext ctx;
+            for (size_t i = next++; i < files.size(); i = next++) {
+                FileResult &r = results[i];
+                r.path = files[i];
+                try {
+                    ctx.read_into(files[i], r.collection, options.read);
+                } catch (const std::exception &e) {
+                    r.collection = FeatureCollection{};
+                    r.error = e.what();
+                }
+            }
+        });
+        return results;
+    }
+
+    // Lists the regular files in 'directory' whose names match 'pattern' ('*' and '?' wildcards), sorted
+    // by path. Subdirectories are not searched.
+    inline std::vector<std::filesystem::path> ListFiles(const std::filesystem::path &directory,
+                                                        std::string_view pattern = "*") {
+        std::error_code ec;
+        std::filesystem::directory_iterator it(directory, ec);
+        if (ec) {
+            throw std::runtime_error("vectkit::ListFiles(): cannot list \"" + directory.string() +
+                                     "\": " + ec.message());
+        }
+        std::vector<std::filesystem::path> files;
+        for (const auto &entry : it) {
+            if (entry.is_regular_file(ec) && detail::wildcard_match(entry.path().filename().string(), pattern))
+                files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    inline std::vector<FileResult> ReadFeatureCollections(const std::filesystem::path &directory,
+                                                          std::string_view pattern,
+                                                          const BatchOptions &options = {}) {
+        auto files = ListFiles(directory, pattern);
+        return ReadFeatureCollections(files, options);
+    }
+
+} // namespace vectkit
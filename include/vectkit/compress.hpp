@@ -0,0 +1,383 @@
+#pragma once
+
+#include "vectkit/io.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#ifdef VECTKIT_HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef VECTKIT_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace vectkit {
+
+    // How a file is compressed on disk. Inputs are recognised by their magic bytes, whatever their name;
+    // outputs are compressed according to their extension (.gz, .zst).
+    enum class Compression { None, Gzip, Zstd };
+
+    namespace detail {
+        inline Compression sniff_compression(std::string_view head) {
+            if (head.size() >= 2 && head[0] == '\x1f' && head[1] == '\x8b')
+                return Compression::Gzip;
+            if (head.size() >= 4 && head.substr(0, 4) == std::string_view("\x28\xb5\x2f\xfd", 4))
+                return Compression::Zstd;
+            return Compression::None;
+        }
+
+        inline Compression compression_for(const std::filesystem::path &file) {
+            auto ext = file.extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+            if (ext == ".gz" || ext == ".gzip")
+                return Compression::Gzip;
+            if (ext == ".zst" || ext == ".zstd")
+                return Compression::Zstd;
+            return Compression::None;
+        }
+
+        inline bool compression_available(Compression c) {
+            switch (c) {
+            case Compression::None:
+                return true;
+            case Compression::Gzip:
+#ifdef VECTKIT_HAS_ZLIB
+                return true;
+#else
+                return false;
+#endif
+            case Compression::Zstd:
+#ifdef VECTKIT_HAS_ZSTD
+                return true;
+#else
+                return false;
+#endif
+            }
+            return false;
+        }
+
+        inline const char *compression_name(Compression c) {
+            switch (c) {
+            case Compression::Gzip:
+                return "gzip";
+            case Compression::Zstd:
+                return "zstd";
+            default:
+                return "uncompressed";
+            }
+        }
+
+        [[noreturn]] inline void compression_unavailable(Compression c, const std::string &who) {
+            throw std::runtime_error(who + ": " + compression_name(c) + " support was not compiled in (build with " +
+                                     (c == Compression::Gzip ? "zlib" : "libzstd") + " available)");
+        }
+
+        // Streaming decompressor for one input. Concatenated gzip members and zstd frames are decoded one
+        // after the other, as the command line tools do.
+        class Decompressor {
+          public:
+            Decompressor(Compression c, std::string who) : kind_(c), who_(std::move(who)) {
+                if (!compression_available(c) || c == Compression::None)
+                    compression_unavailable(c, who_);
+#ifdef VECTKIT_HAS_ZLIB
+                if (c == Compression::Gzip && inflateInit2(&z_, 15 + 16) != Z_OK)
+                    throw std::runtime_error(who_ + ": cannot initialise zlib");
+#endif
+#ifdef VECTKIT_HAS_ZSTD
+                if (c == Compression::Zstd && !(zstd_ = ZSTD_createDCtx()))
+                    throw std::runtime_error(who_ + ": cannot initialise zstd");
+#endif
+            }
+
+            Decompressor(const Decompressor &) = delete;
+            Decompressor &operator=(const Decompressor &) = delete;
+
+            ~Decompressor() {
+#ifdef VECTKIT_HAS_ZLIB
+                if (kind_ == Compression::Gzip)
+                    inflateEnd(&z_);
+#endif
+#ifdef VECTKIT_HAS_ZSTD
+                ZSTD_freeDCtx(zstd_);
+#endif
+            }
+
+            // Starts over, for sources that are read a second time
+            void reset() {
+#ifdef VECTKIT_HAS_ZLIB
+                if (kind_ == Compression::Gzip)
+                    inflateReset(&z_);
+#endif
+#ifdef VECTKIT_HAS_ZSTD
+                if (zstd_)
+                    ZSTD_DCtx_reset(zstd_, ZSTD_reset_session_only);
+#endif
+                mid_stream_ = false;
+            }
+
+            // Decodes from in (advancing it past what was consumed) into at most n bytes at out; returns the
+            // number of bytes written, 0 when more input is needed
+            size_t run(std::string_view &in, char *out, size_t n) {
+                size_t produced = 0;
+#ifdef VECTKIT_HAS_ZLIB
+                if (kind_ == Compression::Gzip) {
+                    z_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+                    z_.avail_in = static_cast<uInt>(std::min<size_t>(in.size(), UINT32_MAX));
+                    z_.next_out = reinterpret_cast<Bytef *>(out);
+                    z_.avail_out = static_cast<uInt>(std::min<size_t>(n, UINT32_MAX));
+                    size_t before = z_.avail_in;
+                    int ret = inflate(&z_, Z_NO_FLUSH);
+                    in.remove_prefix(before - z_.avail_in);
+                    produced = static_cast<size_t>(reinterpret_cast<char *>(z_.next_out) - out);
+                    if (ret == Z_STREAM_END) {
+                        inflateReset(&z_);
+                        mid_stream_ = false;
+                    } else if (ret == Z_OK || ret == Z_BUF_ERROR) {
+                        mid_stream_ = mid_stream_ || before != z_.avail_in || produced > 0;
+                    } else {
+                        throw std::runtime_error(who_ + ": corrupt gzip data" +
+                                                 (z_.msg ? std::string(" (") + z_.msg + ")" : std::string()));
+                    }
+                }
+#endif
+#ifdef VECTKIT_HAS_ZSTD
+                if (kind_ == Compression::Zstd) {
+                    ZSTD_inBuffer src{in.data(), in.size(), 0};
+                    ZSTD_outBuffer dst{out, n, 0};
+                    size_t ret = ZSTD_decompressStream(zstd_, &dst, &src);
+                    if (ZSTD_isError(ret))
+                        throw std::runtime_error(who_ + ": corrupt zstd data (" + ZSTD_getErrorName(ret) + ")");
+                    in.remove_prefix(src.pos);
+                    produced = dst.pos;
+                    mid_stream_ = ret != 0;
+                }
+#endif
+                return produced;
+            }
+
+            // Called once the input is exhausted and run() has nothing left to give
+            void finish() const {
+                if (mid_stream_)
+                    throw std::runtime_error(who_ + ": truncated " + compression_name(kind_) + " data");
+            }
+
+          private:
+            Compression kind_;
+            std::string who_;
+            bool mid_stream_ = false;
+#ifdef VECTKIT_HAS_ZLIB
+            z_stream z_{};
+#endif
+#ifdef VECTKIT_HAS_ZSTD
+            ZSTD_DCtx *zstd_ = nullptr;
+#endif
+        };
+
+        // Decompresses a whole input into out, replacing its contents. out keeps its capacity, so a buffer
+        // reused across reads stops allocating once it has grown.
+        inline void decompress(std::string_view in, Compression c, std::string &out, const std::string &who) {
+            Decompressor dec(c, who);
+            out.clear();
+            // A single gzip member ends with its size modulo 4 GiB, which is the right size for any
+            // sensible GeoJSON file; otherwise guess from a typical text compression ratio.
+            size_t hint = in.size() * 4;
+            if (c == Compression::Gzip && in.size() >= 18) {
+                auto t = reinterpret_cast<const unsigned char *>(in.data() + in.size() - 4);
+                size_t isize = size_t(t[0]) | size_t(t[1]) << 8 | size_t(t[2]) << 16 | size_t(t[3]) << 24;
+                if (isize >= in.size())
+                    hint = isize;
+            }
+            out.resize(std::max<size_t>(hint, 1 << 16));
+            size_t used = 0;
+            for (;;) {
+                if (used == out.size())
+                    out.resize(out.size() * 2);
+                size_t left = in.size();
+                size_t got = dec.run(in, out.data() + used, out.size() - used);
+                used += got;
+                if (got == 0 && in.size() == left)
+                    break;
+            }
+            dec.finish();
+            out.resize(used);
+        }
+
+        // InputSource that looks at the first bytes of another source and transparently decompresses it
+        // if they are a gzip or zstd magic number; anything else is passed through unchanged. Only one
+        // compressed chunk is held at a time, so streaming readers stay bounded on compressed files too.
+        class DecodingSource : public InputSource {
+          public:
+            DecodingSource(std::unique_ptr<InputSource> inner, std::string who, size_t chunk = size_t(1) << 16)
+                : inner_(std::move(inner)), buf_(chunk, '\0') {
+                size_t n = fill();
+                kind_ = sniff_compression(pending_.substr(0, n));
+                if (kind_ != Compression::None)
+                    dec_ = std::make_unique<Decompressor>(kind_, std::move(who));
+            }
+
+            Compression compression() const { return kind_; }
+
+            size_t read(char *dst, size_t n) override {
+                if (!dec_) {
+                    if (pending_.empty())
+                        return inner_->read(dst, n);
+                    size_t k = std::min(n, pending_.size());
+                    std::memcpy(dst, pending_.data(), k);
+                    pending_.remove_prefix(k);
+                    return k;
+                }
+                for (;;) {
+                    if (pending_.empty() && !eof_)
+                        fill();
+                    size_t got = dec_->run(pending_, dst, n);
+                    if (got > 0)
+                        return got;
+                    if (pending_.empty() && eof_) {
+                        dec_->finish();
+                        return 0;
+                    }
+                }
+            }
+
+            bool rewind() override {
+                if (!inner_->rewind())
+                    return false;
+                pending_ = {};
+                eof_ = false;
+                if (dec_)
+                    dec_->reset();
+                return true;
+            }
+
+          private:
+            // Reads the next chunk (the magic number may straddle short reads from pipes)
+            size_t fill() {
+                size_t n = 0;
+                while (n < buf_.size()) {
+                    size_t got = inner_->read(buf_.data() + n, buf_.size() - n);
+                    if (got == 0) {
+                        eof_ = true;
+                        break;
+                    }
+                    n += got;
+                    if (n >= 4)
+                        break;
+                }
+                pending_ = std::string_view(buf_.data(), n);
+                return n;
+            }
+
+            std::unique_ptr<InputSource> inner_;
+            std::string buf_;
+            std::string_view pending_;
+            bool eof_ = false;
+            Compression kind_ = Compression::None;
+            std::unique_ptr<Decompressor> dec_;
+        };
+
+        // Compresses everything written to it into sink, one output chunk at a time. finish() must be called
+        // to end the stream; a stream that is dropped without it is truncated.
+        class CompressedOutput {
+          public:
+            CompressedOutput(OutputSink &sink, Compression c, std::string who, size_t chunk = size_t(1) << 16)
+                : sink_(sink), kind_(c), who_(std::move(who)), buf_(chunk, '\0') {
+                if (!compression_available(c) || c == Compression::None)
+                    compression_unavailable(c, who_);
+#ifdef VECTKIT_HAS_ZLIB
+                if (c == Compression::Gzip &&
+                    deflateInit2(&z_, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+                    throw std::runtime_error(who_ + ": cannot initialise zlib");
+#endif
+#ifdef VECTKIT_HAS_ZSTD
+                if (c == Compression::Zstd && !(zstd_ = ZSTD_createCCtx()))
+                    throw std::runtime_error(who_ + ": cannot initialise zstd");
+#endif
+            }
+
+            CompressedOutput(const CompressedOutput &) = delete;
+            CompressedOutput &operator=(const CompressedOutput &) = delete;
+
+            ~CompressedOutput() {
+#ifdef VECTKIT_HAS_ZLIB
+                if (kind_ == Compression::Gzip)
+                    deflateEnd(&z_);
+#endif
+#ifdef VECTKIT_HAS_ZSTD
+                ZSTD_freeCCtx(zstd_);
+#endif
+            }
+
+            void write(std::string_view data) {
+                // zlib counts in 32 bits
+                constexpr size_t step = size_t(1) << 30;
+                for (; data.size() > step; data.remove_prefix(step))
+                    run(data.substr(0, step), false);
+                run(data, false);
+            }
+
+            void finish() { run({}, true); }
+
+          private:
+            void run(std::string_view in, bool last) {
+#ifdef VECTKIT_HAS_ZLIB
+                if (kind_ == Compression::Gzip) {
+                    z_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+                    z_.avail_in = static_cast<uInt>(in.size());
+                    int ret;
+                    do {
+                        z_.next_out = reinterpret_cast<Bytef *>(buf_.data());
+                        z_.avail_out = static_cast<uInt>(buf_.size());
+                        ret = deflate(&z_, last ? Z_FINISH : Z_NO_FLUSH);
+                        if (ret == Z_STREAM_ERROR)
+                            throw std::runtime_error(who_ + ": gzip compression failed");
+                        emit(buf_.size() - z_.avail_out);
+                    } while (z_.avail_out == 0 || (last && ret != Z_STREAM_END));
+                }
+#endif
+#ifdef VECTKIT_HAS_ZSTD
+                if (kind_ == Compression::Zstd) {
+                    ZSTD_inBuffer src{in.data(), in.size(), 0};
+                    size_t left;
+                    do {
+                        ZSTD_outBuffer dst{buf_.data(), buf_.size(), 0};
+                        left = ZSTD_compressStream2(zstd_, &dst, &src, last ? ZSTD_e_end : ZSTD_e_continue);
+                        if (ZSTD_isError(left))
+                            throw std::runtime_error(who_ + ": zstd compression failed (" +
+                                                     ZSTD_getErrorName(left) + ")");
+                        emit(dst.pos);
+                    } while (src.pos < src.size || (last && left != 0));
+                }
+#endif
+                (void)in;
+                (void)last;
+            }
+
+            void emit(size_t n) {
+                if (n > 0)
+                    sink_.write(std::string_view(buf_.data(), n));
+            }
+
+            OutputSink &sink_;
+            Compression kind_;
+            std::string who_;
+            std::string buf_;
+#ifdef VECTKIT_HAS_ZLIB
+            z_stream z_{};
+#endif
+#ifdef VECTKIT_HAS_ZSTD
+            ZSTD_CCtx *zstd_ = nullptr;
+#endif
+        };
+    } // namespace detail
+
+} // namespace vectkit
@@ -0,0 +1,1037 @@
+#pragma once
+
+#include "vectkit/pool.hpp"
+#include "vectkit/scan.hpp"
+#include "vectkit/types.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace vectkit {
+
+    namespace detail {
+        // Recursive-descent reader over a complete JSON text. Unlike the scan:: helpers it never sees a
+        // truncated value, so running out of input is always a syntax error.
+        class Cursor {
+          public:
+            Cursor(const char *begin, const char *end) : p_(begin), end_(end) {}
+            explicit Cursor(std::string_view text) : Cursor(text.data(), text.data() + text.size()) {}
+
+            // Next non-whitespace byte without consuming it, or 0 at end of input
+            char peek() {
+                p_ = scan::skip_ws(p_, end_);
+                return p_ < end_ ? *p_ : 0;
+            }
+
+            bool consume(char c) {
+                if (peek() != c)
+                    return false;
+                ++p_;
+                return true;
+            }
+
+            void expect(char c, const char *what) {
+                if (!consume(c))
+                    scan::fail(what);
+            }
+
+            // Consumes a string and returns its raw body (escapes still encoded)
+            std::string_view string_body() {
+                if (peek() != '"')
+                    scan::fail("expected string");
+                const char *e = scan::skip_string(p_, end_);
+                if (!e)
+                    scan::fail("unexpected end of input");
+                std::string_view body(p_ + 1, static_cast<size_t>(e - p_ - 2));
+                p_ = e;
+                return body;
+            }
+
+            double number() {
+                peek();
+                const char *start = p_;
+                p_ = scan::number_end(p_, end_);
+                if (p_ == start)
+                    scan::fail("unexpected character");
+                return scan::parse_number(start, static_cast<size_t>(p_ - start));
+            }
+
+            const char *position() const { return p_; }
+            const char *end() const { return end_; }
+            void seek(const char *p) { p_ = p; }
+
+            // Consumes any value and returns its text
+            std::string_view skip() {
+                peek();
+                const char *e = scan::skip_value(p_, end_);
+                if (!e)
+                    scan::fail("unexpected end of input");
+                std::string_view v(p_, static_cast<size_t>(e - p_));
+                p_ = e;
+                return v;
+            }
+
+            // Calls on_member(raw_key) with the cursor on each member's value; on_member must consume it
+            template <typename OnMember> void object(OnMember &&on_member) {
+                expect('{', "expected '{'");
+                if (consume('}'))
+                    return;
+                do {
+                    auto key = string_body();
+                    expect(':', "expected ':'");
+                    on_member(key);
+                } while (consume(','));
+                expect('}', "expected ',' or '}'");
+            }
+
+            // Calls on_element() with the cursor on each element; on_element must consume it
+            template <typename OnElement> void array(OnElement &&on_element) {
+                expect('[', "expected '['");
+                if (consume(']'))
+                    return;
+                do {
+                    on_element();
+                } while (consume(','));
+                expect(']', "expected ',' or ']'");
+            }
+
+          private:
+            const char *p_;
+            const char *end_;
+        };
+
+        // Maps a position given in the collection's CRS to the local ENU frame
+        inline dp::Point to_local(double x, double y, double z, bool has_z, const dp::Geo &datum, CRS crs) {
+            if (crs == CRS::ENU)
+                return dp::Point{x, y, z};
+
+            // If input has no Z value (2D GeoJSON), use datum altitude to avoid
+            // large Z offsets due to Earth curvature in the ENU frame
+            double wgs_alt = has_z ? z : datum.altitude;
+            concord::earth::WGS wgs{y, x, wgs_alt};
+            auto enu = concord::frame::to_enu(datum, wgs);
+            // For 2D input, set Z to altitude difference from datum (typically 0)
+            double enu_z = has_z ? enu.up() : (z - datum.altitude);
+            return dp::Point{enu.east(), enu.north(), enu_z};
+        }
+
+        // Applies to_local to a geometry read by an unlocalized FeatureDecoder
+        inline void localize(Geometry &geometry, const dp::Geo &datum, CRS crs) {
+            auto fix = [&](dp::Point &p) {
+                bool has_z = !std::isnan(p.z);
+                p = to_local(p.x, p.y, has_z ? p.z : 0.0, has_z, datum, crs);
+            };
+            std::visit(
+                [&](auto &g) {
+                    using T = std::decay_t<decltype(g)>;
+                    if constexpr (std::is_same_v<T, dp::Point>) {
+                        fix(g);
+                    } else if constexpr (std::is_same_v<T, dp::Segment>) {
+                        fix(g.start);
+                        fix(g.end);
+                    } else if constexpr (std::is_same_v<T, dp::Polygon>) {
+                        for (auto &p : g.vertices)
+                            fix(p);
+                    } else if constexpr (std::is_same_v<T, std::vector<dp::Point>>) {
+                        for (auto &p : g)
+                            fix(p);
+                    } else {
+                        for (auto &p : g.points)
+                            fix(p);
+                    }
+                },
+                geometry);
+        }
+
+        // Raw body of a geometry's 'type' string
+        inline GeometryType geometry_type(std::string_view raw) {
+            if (scan::key_equals(raw, "Point"))
+                return GeometryType::Point;
+            if (scan::key_equals(raw, "LineString"))
+                return GeometryType::LineString;
+            if (scan::key_equals(raw, "Polygon"))
+                return GeometryType::Polygon;
+            if (scan::key_equals(raw, "MultiPoint"))
+                return GeometryType::MultiPoint;
+            if (scan::key_equals(raw, "MultiLineString"))
+                return GeometryType::MultiLineString;
+            if (scan::key_equals(raw, "MultiPolygon"))
+                return GeometryType::MultiPolygon;
+            if (scan::key_equals(raw, "GeometryCollection"))
+                return GeometryType::GeometryCollection;
+            return GeometryType::Unknown;
+        }
+
+        // A read's query region in the coordinates the file is written in (longitude/latitude or
+        // east/north), so features can be tested before any of their points is converted
+        class RegionTest {
+          public:
+            void clear() {
+                ring_.clear();
+                min_x_ = min_y_ = std::numeric_limits<double>::infinity();
+                max_x_ = max_y_ = -std::numeric_limits<double>::infinity();
+                rectangle_ = false;
+            }
+
+            void add(double x, double y) {
+                ring_.push_back({x, y});
+                min_x_ = std::min(min_x_, x);
+                min_y_ = std::min(min_y_, y);
+                max_x_ = std::max(max_x_, x);
+                max_y_ = std::max(max_y_, y);
+            }
+
+            // Call once all vertices are in
+            void close() {
+                rectangle_ = ring_.size() == 4;
+                for (size_t i = 0; i < ring_.size() && rectangle_; ++i) {
+                    const XY &a = ring_[i];
+                    const XY &b = ring_[(i + 1) % ring_.size()];
+                    rectangle_ = a.x == b.x || a.y == b.y;
+                }
+            }
+
+            // Whether anything inside the box [min, max] can lie in the region
+            bool overlaps(double min_x, double min_y, double max_x, double max_y) const {
+                if (max_x < min_x_ || min_x > max_x_ || max_y < min_y_ || min_y > max_y_)
+                    return false;
+                if (rectangle_)
+                    return true;
+                for (size_t i = 0; i < ring_.size(); ++i) {
+                    if (segment_hits(ring_[i], ring_[(i + 1) % ring_.size()], min_x, min_y, max_x, max_y))
+                        return true;
+                }
+                return contains(min_x, min_y); // the box lies entirely inside or entirely outside
+            }
+
+            // Same test for a geometry read by an unlocalized FeatureDecoder
+            bool overlaps(const Geometry &geometry) const {
+                double x0 = std::numeric_limits<double>::infinity(), y0 = x0;
+                double x1 = -x0, y1 = -x0;
+                auto grow = [&](const dp::Point &p) {
+                    x0 = std::min(x0, p.x);
+                    y0 = std::min(y0, p.y);
+                    x1 = std::max(x1, p.x);
+                    y1 = std::max(y1, p.y);
+                };
+                std::visit(
+                    [&](const auto &g) {
+                        using T = std::decay_t<decltype(g)>;
+                        if constexpr (std::is_same_v<T, dp::Point>) {
+                            grow(g);
+                        } else if constexpr (std::is_same_v<T, dp::Segment>) {
+                            grow(g.start);
+                            grow(g.end);
+                        } else if constexpr (std::is_same_v<T, dp::Polygon>) {
+                            for (const auto &p : g.vertices)
+                                grow(p);
+                        } else if constexpr (std::is_same_v<T, std::vector<dp::Point>>) {
+                            for (const auto &p : g)
+                                grow(p);
+                        } else {
+                            for (const auto &p : g.points)
+                                grow(p);
+                        }
+                    },
+                    geometry);
+                return x0 > x1 || overlaps(x0, y0, x1, y1); // nothing to test in an empty geometry
+            }
+
+          private:
+            struct XY {
+                double x, y;
+            };
+
+            // Liang-Barsky clipping of the segment ab against the box
+            static bool segment_hits(XY a, XY b, double min_x, double min_y, double max_x, double max_y) {
+                double t0 = 0.0, t1 = 1.0;
+                auto clip = [&](double p, double q) {
+                    if (p == 0.0)
+                        return q >= 0.0;
+                    double r = q / p;
+                    if (p < 0.0) {
+                        if (r > t1)
+                            return false;
+                        t0 = std::max(t0, r);
+                    } else {
+                        if (r < t0)
+                            return false;
+                        t1 = std::min(t1, r);
+                    }
+                    return true;
+                };
+                double dx = b.x - a.x, dy = b.y - a.y;
+                return clip(-dx, a.x - min_x) && clip(dx, max_x - a.x) && clip(-dy, a.y - min_y) &&
+                       clip(dy, max_y - a.y);
+            }
+
+            // Even-odd rule
+            bool contains(double x, double y) const {
+                bool inside = false;
+                for (size_t i = 0, j = ring_.size() - 1; i < ring_.size(); j = i++) {
+                    const XY &a = ring_[i];
+                    const XY &b = ring_[j];
+                    if ((a.y > y) != (b.y > y) && x < (b.x - a.x) * (y - a.y) / (b.y - a.y) + a.x)
+                        inside = !inside;
+                }
+                return inside;
+            }
+
+            std::vector<XY> ring_;
+            double min_x_ = 0.0, min_y_ = 0.0, max_x_ = 0.0, max_y_ = 0.0;
+            bool rectangle_ = false;
+        };
+
+        // What a read keeps (see ReadOptions). The pointers refer to the options of the read in progress.
+        struct FeatureFilter {
+            const std::vector<std::string> *keep = nullptr; // property keys to keep; nullptr keeps all
+            const std::function<bool(const Properties::Map &)> *where = nullptr;
+            std::uint32_t types = ~std::uint32_t(0); // one bit per GeometryType
+            const RegionTest *region = nullptr;      // in the frame of the coordinates being read
+            bool multipart = false;                  // Multi* and holed polygons are kept whole
+        };
+
+        // Decodes 'features' entries straight from the input text into Features, without building a
+        // generic DOM first. A feature's geometry is read in a single pass whatever the member order
+        // ("coordinates" often precedes "type"): nested coordinate arrays are recorded as a flat
+        // pre-order list of nodes, and turned into points once the geometry object closes and its type
+        // is known. Point storage is reserved at its exact size, and all scratch buffers are reused
+        // from one feature to the next.
+        class FeatureDecoder {
+          public:
+            using PropertyMap = Properties::Map;
+
+            FeatureDecoder() = default;
+            FeatureDecoder(const dp::Geo &datum, CRS crs) : datum_(datum), crs_(crs) {}
+
+            // For input whose header may come after its coordinates: points keep the numbers as written,
+            // with a missing z stored as NaN, until localize() is applied once the datum is known
+            static FeatureDecoder unlocalized() {
+                FeatureDecoder d;
+                d.reset_unlocalized();
+                return d;
+            }
+
+            // Start over with another frame, keeping the scratch buffers' capacity
+            void reset(const dp::Geo &datum, CRS crs) {
+                datum_ = datum;
+                crs_ = crs;
+                localize_ = true;
+                nodes_.clear();
+            }
+
+            void reset_unlocalized() {
+                localize_ = false;
+                nodes_.clear();
+            }
+
+            void select(const FeatureFilter &filter) { filter_ = filter; }
+
+            // With a source, the input being decoded lies in memory it keeps alive, and properties the
+            // filter does not need to look at are kept as slices of it, decoded on first access
+            void defer_properties(std::shared_ptr<const void> source) { source_ = std::move(source); }
+
+            // Same frame and filter with empty buffers, for decoding another stretch of the input on
+            // another thread
+            FeatureDecoder fork() const {
+                FeatureDecoder d(datum_, crs_);
+                d.localize_ = localize_;
+                d.filter_ = filter_;
+                d.source_ = source_;
+                return d;
+            }
+
+            // Takes back the storage of features that are about to be replaced and clears the vector. The
+            // next features decoded are built in it: point buffers, property maps and their entries are
+            // refilled in place, so re-reading data of the same shape allocates nothing. A property map
+            // shared between features is taken back from the last of them; one still referenced from
+            // elsewhere is left alone.
+            void recycle(std::vector<Feature> &features) {
+                for (auto it = features.rbegin(); it != features.rend(); ++it) {
+                    if (auto *path = std::get_if<std::vector<dp::Point>>(&it->geometry))
+                        spare_paths_.push_back(std::move(*path));
+                    else if (auto *poly = std::get_if<dp::Polygon>(&it->geometry))
+                        spare_polygons_.push_back(std::move(*poly));
+                    auto &map = it->properties.map_;
+                    if (map && map.use_count() == 1)
+                        recycle(std::move(map));
+                    map.reset();
+                }
+                features.clear();
+            }
+
+            // Whether the filter's predicate, if any, accepts a feature with these properties
+            bool accepts(const PropertyMap &props) const { return !filter_.where || (*filter_.where)(props); }
+
+            // Drops the properties the filter does not keep
+            void project(PropertyMap &props) {
+                if (!filter_.keep)
+                    return;
+                for (size_t i = 0; i < props.size();) {
+                    PropertyKey key = props.begin()[static_cast<std::ptrdiff_t>(i)].first;
+                    if (kept(key))
+                        ++i;
+                    else
+                        props.erase(key);
+                }
+            }
+
+            // Consumes one 'features' array element, appending one Feature per resulting geometry
+            // (GeometryCollection geometries are flattened, and so are Multi* ones unless the filter keeps
+            // them whole). Non-objects and null geometries are skipped.
+            void decode(Cursor &c, std::vector<Feature> &out) {
+                if (c.peek() != '{') {
+                    c.skip();
+                    return;
+                }
+
+                nodes_.clear();
+                geometries_.clear();
+                bool have_geometry = false;
+                bool have_properties = false;
+                bool rejected = false;
+                std::string_view deferred, raw_properties;
+                std::shared_ptr<PropertyMap> props = take(spare_maps_);
+                if (!props) {
+                    props = std::make_shared<PropertyMap>();
+                    props->reserve(property_hint_); // sized like the previous feature's set
+                }
+                c.object([&](std::string_view key) {
+                    if (!have_geometry && scan::key_equals(key, "geometry")) {
+                        have_geometry = true;
+                        if (rejected)
+                            c.skip();
+                        else if (filter_.where && !have_properties)
+                            deferred = c.skip(); // decoded once the properties have been checked
+                        else
+                            read_geometry(c, geometries_);
+                    } else if (!have_properties && scan::key_equals(key, "properties")) {
+                        have_properties = true;
+                        if (deferring())
+                            raw_properties = c.skip();
+                        else
+                            read_properties(c, *props);
+                        rejected = !accepts(*props);
+                    } else {
+                        c.skip();
+                    }
+                });
+
+                if (!have_properties)
+                    rejected = !accepts(*props);
+                if (rejected) {
+                    recycle(std::move(props));
+                    return;
+                }
+                if (!deferred.empty()) {
+                    Cursor geometry(deferred);
+                    read_geometry(geometry, geometries_);
+                }
+                project(*props);
+                property_hint_ = props->size();
+
+                // Every part refers to the same property set
+                Properties shared;
+                if (props->empty() || geometries_.empty())
+                    recycle(std::move(props));
+                else
+                    shared = Properties(std::move(props));
+                if (!raw_properties.empty() && !geometries_.empty() && !empty_object(raw_properties)) {
+                    auto lazy = std::make_shared<Properties::Lazy>();
+                    lazy->source = source_;
+                    lazy->text = raw_properties;
+                    lazy->decode = &FeatureDecoder::decode_properties;
+                    shared = Properties(std::move(lazy));
+                }
+                for (size_t i = 0; i < geometries_.size(); ++i) {
+                    if (i + 1 == geometries_.size())
+                        out.emplace_back(Feature{std::move(geometries_[i]), std::move(shared)});
+                    else
+                        out.emplace_back(Feature{std::move(geometries_[i]), shared});
+                }
+                geometries_.clear();
+            }
+
+            // Consumes a geometry object, appending its geometries (more than one for Multi* types and
+            // GeometryCollection). Anything that is not a well-formed geometry yields nothing.
+            void read_geometry(Cursor &c, std::vector<Geometry> &out) {
+                if (c.peek() != '{') {
+                    c.skip();
+                    return;
+                }
+
+                GeometryType type = GeometryType::Unknown;
+                bool have_type = false;
+                bool have_coords = false;
+                bool have_geometries = false;
+                size_t root = no_coordinates;
+                std::vector<Geometry> members;
+                c.object([&](std::string_view key) {
+                    if (!have_type && scan::key_equals(key, "type")) {
+                        have_type = true;
+                        if (c.peek() == '"')
+                            type = geometry_type(c.string_body());
+                        else
+                            c.skip();
+                    } else if (!have_coords && scan::key_equals(key, "coordinates")) {
+                        have_coords = true;
+                        if (have_type && !wanted(type))
+                            c.skip();
+                        else
+                            root = read_coordinates(c);
+                    } else if (!have_geometries && scan::key_equals(key, "geometries")) {
+                        have_geometries = true;
+                        read_geometries(c, members);
+                    } else {
+                        c.skip();
+                    }
+                });
+
+                if (type == GeometryType::GeometryCollection) {
+                    for (auto &g : members)
+                        out.emplace_back(std::move(g));
+                    return;
+                }
+                build(type, root, out);
+            }
+
+            static constexpr size_t no_coordinates = SIZE_MAX;
+
+            // Consumes a 'coordinates' value and returns the handle build() takes, or no_coordinates if it
+            // is not an array. Handles stay valid until the next decode().
+            size_t read_coordinates(Cursor &c) {
+                if (c.peek() != '[') {
+                    c.skip();
+                    return no_coordinates;
+                }
+                size_t root = nodes_.size();
+                read_array(c, 0);
+                return root;
+            }
+
+            // Consumes a 'geometries' value, appending each member's geometries
+            void read_geometries(Cursor &c, std::vector<Geometry> &out) {
+                if (c.peek() != '[') {
+                    c.skip();
+                    return;
+                }
+                c.array([&] { read_geometry(c, out); });
+            }
+
+            // Turns coordinates read earlier into geometries of the given type, unless the filter excludes
+            // it. Multi* parts are tested against the filter's region one by one, unless kept whole.
+            void build(GeometryType type, size_t root, std::vector<Geometry> &out) {
+                if (root == no_coordinates || !wanted(type))
+                    return;
+
+                if (filter_.multipart) {
+                    switch (type) {
+                    case GeometryType::Polygon:
+                        if (children(root) > 1) {
+                            if (reaches(root))
+                                out.emplace_back(polygon_with_holes(root));
+                            return;
+                        }
+                        break;
+                    case GeometryType::MultiPoint:
+                        if (reaches(root))
+                            out.emplace_back(multi_point(root));
+                        return;
+                    case GeometryType::MultiLineString:
+                        if (reaches(root))
+                            out.emplace_back(multi_line_string(root));
+                        return;
+                    case GeometryType::MultiPolygon:
+                        if (reaches(root))
+                            out.emplace_back(multi_polygon(root));
+                        return;
+                    default:
+                        break;
+                    }
+                }
+
+                switch (type) {
+                case GeometryType::Point:
+                    if (reaches(root))
+                        out.emplace_back(point(root));
+                    break;
+                case GeometryType::LineString:
+                    if (reaches(root))
+                        out.emplace_back(line_string(root));
+                    break;
+                case GeometryType::Polygon:
+                    if (reaches(root))
+                        out.emplace_back(polygon(root));
+                    break;
+                case GeometryType::MultiPoint:
+                    for (size_t i = root + 1; i < nodes_[root].end; i = nodes_[i].end) {
+                        if (reaches(i))
+                            out.emplace_back(point(i));
+                    }
+                    break;
+                case GeometryType::MultiLineString:
+                    for (size_t i = root + 1; i < nodes_[root].end; i = nodes_[i].end) {
+                        if (reaches(i))
+                            out.emplace_back(line_string(i));
+                    }
+                    break;
+                case GeometryType::MultiPolygon:
+                    for (size_t i = root + 1; i < nodes_[root].end; i = nodes_[i].end) {
+                        if (reaches(i))
+                            out.emplace_back(polygon(i));
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            // Consumes a 'properties' value into typed values (see PropertyValue). Non-objects add
+            // nothing. Without a predicate to feed, keys the filter does not keep are skipped here already.
+            void read_properties(Cursor &c, PropertyMap &props) {
+                if (c.peek() != '{') {
+                    c.skip();
+                    return;
+                }
+                c.object([&](std::string_view raw_key) {
+                    PropertyKey key = intern(raw_key);
+                    if (!filter_.where && !kept(key)) {
+                        c.skip();
+                        return;
+                    }
+                    auto it = props.find(key);
+                    property_value(c, it != props.end() ? it->second : props.slot(key));
+                });
+            }
+
+            // Decodes a 'properties' object kept as text by a lazy read; the text was validated when read
+            static void decode_properties(std::string_view text, PropertyMap &out) {
+                Cursor c(text);
+                if (c.peek() != '{')
+                    return;
+                std::string name;
+                c.object([&](std::string_view raw_key) {
+                    scan::unescape(raw_key, name);
+                    PropertyKey key(name);
+                    auto it = out.find(key);
+                    property_value(c, it != out.end() ? it->second : out.slot(key));
+                });
+            }
+
+          private:
+            // Consumes a property value into slot, refilling its string buffer in place
+            static void property_value(Cursor &c, PropertyValue &slot) {
+                using Type = PropertyValue::Type;
+                char first = c.peek();
+                if (first == '"') {
+                    scan::unescape(c.string_body(), slot.text(Type::String));
+                    return;
+                }
+                auto raw = c.skip();
+                if (first == 't' || first == 'f') {
+                    slot.type_ = Type::Bool;
+                    slot.bool_ = first == 't';
+                } else if (first == 'n') {
+                    slot.type_ = Type::Null;
+                } else if (first == '-' || (first >= '0' && first <= '9')) {
+                    slot.assign_number(raw);
+                } else {
+                    std::string &text = slot.text(Type::Raw);
+                    text.clear();
+                    bool in_string = false;
+                    for (size_t k = 0; k < raw.size(); ++k) {
+                        char ch = raw[k];
+                        if (in_string) {
+                            if (ch == '\\') {
+                                text += ch;
+                                ch = raw[++k]; // skip_value guarantees the escape is complete
+                            } else if (ch == '"') {
+                                in_string = false;
+                            }
+                        } else if (ch == '"') {
+                            in_string = true;
+                        } else if (scan::is_ws(ch)) {
+                            continue;
+                        }
+                        text += ch;
+                    }
+                }
+            }
+
+            // Raw-coordinate bounding box test of the coordinates at node i. Coordinates without a
+            // single position are let through, so they fail or come out empty exactly as without a region.
+            bool reaches(size_t i) const {
+                if (!filter_.region)
+                    return true;
+                double min_x = std::numeric_limits<double>::infinity(), min_y = min_x;
+                double max_x = -min_x, max_y = -min_x;
+                for (size_t j = i; j < nodes_[i].end; ++j) {
+                    const Node &n = nodes_[j];
+                    if (n.first_is_array || n.length < 2)
+                        continue;
+                    min_x = std::min(min_x, n.v[0]);
+                    min_y = std::min(min_y, n.v[1]);
+                    max_x = std::max(max_x, n.v[0]);
+                    max_y = std::max(max_y, n.v[1]);
+                }
+                return min_x > max_x || filter_.region->overlaps(min_x, min_y, max_x, max_y);
+            }
+
+            bool deferring() const { return source_ && !filter_.keep && !filter_.where; }
+
+            // Whether a skipped value holds no properties: not an object, or {}
+            static bool empty_object(std::string_view raw) {
+                const char *end = raw.data() + raw.size();
+                return raw[0] != '{' || *scan::skip_ws(raw.data() + 1, end) == '}';
+            }
+
+            bool wanted(GeometryType type) const { return (filter_.types >> static_cast<unsigned>(type)) & 1u; }
+
+            bool kept(const std::string &key) const {
+                if (!filter_.keep)
+                    return true;
+                return std::find(filter_.keep->begin(), filter_.keep->end(), key) != filter_.keep->end();
+            }
+
+            void recycle(std::shared_ptr<PropertyMap> props) {
+                props->clear();
+                spare_maps_.push_back(std::move(props));
+            }
+
+            template <typename T> static T take(std::vector<T> &spares) {
+                if (spares.empty())
+                    return T{};
+                T t = std::move(spares.back());
+                spares.pop_back();
+                return t;
+            }
+
+            // The key a raw (still escaped) member name stands for. Names already seen by this decoder
+            // are found without unescaping them or touching the shared key table.
+            PropertyKey intern(std::string_view raw_key) {
+                auto it = keys_.find(raw_key);
+                if (it != keys_.end())
+                    return it->second;
+                if (keys_.size() == max_cached_keys)
+                    keys_.clear(); // input with ever new keys: keep the cache bounded
+                scan::unescape(raw_key, key_);
+                PropertyKey key(key_);
+                keys_.emplace(std::string(raw_key), key);
+                return key;
+            }
+
+            static constexpr size_t max_cached_keys = 4096;
+
+            struct TextHash {
+                using is_transparent = void;
+                size_t operator()(std::string_view text) const { return std::hash<std::string_view>()(text); }
+            };
+
+            // One coordinate array. Children follow their parent in nodes_ and a subtree ends at 'end',
+            // so siblings are reached by jumping from one 'end' to the next. Only the first three
+            // numbers are kept: that is all a position uses.
+            struct Node {
+                std::uint32_t end = 0;
+                std::uint32_t length = 0;
+                bool first_is_array = false;
+                double v[3] = {0.0, 0.0, 0.0};
+            };
+
+            void read_array(Cursor &c, size_t depth) {
+                if (depth == scan::max_depth)
+                    scan::fail("nesting too deep");
+
+                size_t index = nodes_.size();
+                nodes_.emplace_back();
+                Node node;
+                c.array([&] {
+                    char ch = c.peek();
+                    if (ch == '[') {
+                        if (node.length == 0)
+                            node.first_is_array = true;
+                        read_array(c, depth + 1);
+                    } else if (ch == '-' || (ch >= '0' && ch <= '9')) {
+                        double v = c.number();
+                        if (node.length < 3)
+                            node.v[node.length] = v;
+                    } else {
+                        c.skip(); // anything else reads as 0
+                    }
+                    ++node.length;
+                });
+                node.end = static_cast<std::uint32_t>(nodes_.size());
+                nodes_[index] = node;
+            }
+
+            dp::Point point(size_t i) const {
+                const Node &n = nodes_[i];
+                if (n.length < 2)
+                    throw std::runtime_error("Invalid point coordinates");
+                bool has_z = n.length > 2;
+                if (!localize_)
+                    return dp::Point{n.v[0], n.v[1], has_z ? n.v[2] : std::numeric_limits<double>::quiet_NaN()};
+                return to_local(n.v[0], n.v[1], has_z ? n.v[2] : 0.0, has_z, datum_, crs_);
+            }
+
+            // Positions of the array at node i, into points_
+            void positions(size_t i) {
+                points_.clear();
+                points_.reserve(children(i));
+                for (size_t j = i + 1; j < nodes_[i].end; j = nodes_[j].end)
+                    points_.push_back(point(j));
+            }
+
+            Geometry line_string(size_t i) {
+                positions(i);
+                if (points_.size() == 2)
+                    return dp::Segment{points_[0], points_[1]};
+                if (spare_paths_.empty())
+                    return std::vector<dp::Point>(points_.begin(), points_.end());
+                auto path = take(spare_paths_);
+                path.assign(points_.begin(), points_.end());
+                return path;
+            }
+
+            // Only the outer ring is kept
+            dp::Polygon polygon(size_t i) {
+                points_.clear();
+                if (nodes_[i].first_is_array)
+                    positions(i + 1);
+                if (spare_polygons_.empty())
+                    return dp::Polygon{dp::Vector<dp::Point>{points_.begin(), points_.end()}};
+                auto poly = take(spare_polygons_);
+                poly.vertices.clear();
+                poly.vertices.reserve(points_.size());
+                for (const auto &p : points_)
+                    poly.vertices.push_back(p);
+                return poly;
+            }
+
+            // Number of arrays directly inside the array at node i
+            size_t children(size_t i) const {
+                size_t count = 0;
+                for (size_t j = i + 1; j < nodes_[i].end; j = nodes_[j].end)
+                    ++count;
+                return count;
+            }
+
+            // Reserves room for every position under node i (arrays holding no array)
+            template <typename T> void reserve_positions(size_t i, T &g) {
+                size_t count = 0;
+                for (size_t j = i + 1; j < nodes_[i].end; ++j)
+                    count += !nodes_[j].first_is_array;
+                g.points.clear();
+                g.points.reserve(count);
+            }
+
+            // Appends the positions of the array at node i and returns where they end
+            std::uint32_t append_positions(size_t i, std::vector<dp::Point> &points) {
+                for (size_t j = i + 1; j < nodes_[i].end; j = nodes_[j].end)
+                    points.push_back(point(j));
+                return static_cast<std::uint32_t>(points.size());
+            }
+
+            MultiPoint multi_point(size_t i) {
+                MultiPoint g;
+                g.points.reserve(children(i));
+                append_positions(i, g.points);
+                return g;
+            }
+
+            MultiLineString multi_line_string(size_t i) {
+                MultiLineString g;
+                reserve_positions(i, g);
+                g.lines.reserve(children(i));
+                for (size_t j = i + 1; j < nodes_[i].end; j = nodes_[j].end)
+                    g.lines.push_back(append_positions(j, g.points));
+                return g;
+            }
+
+            PolygonWithHoles polygon_with_holes(size_t i) {
+                PolygonWithHoles g;
+                reserve_positions(i, g);
+                g.rings.reserve(children(i));
+                for (size_t j = i + 1; j < nodes_[i].end; j = nodes_[j].end)
+                    g.rings.push_back(append_positions(j, g.points));
+                return g;
+            }
+
+            MultiPolygon multi_polygon(size_t i) {
+                MultiPolygon g;
+                reserve_positions(i, g);
+                g.polygons.reserve(children(i));
+                for (size_t j = i + 1; j < nodes_[i].end; j = nodes_[j].end) {
+                    for (size_t k = j + 1; k < nodes_[j].end; k = nodes_[k].end)
+                        g.rings.push_back(append_positions(k, g.points));
+                    g.polygons.push_back(static_cast<std::uint32_t>(g.rings.size()));
+                }
+                return g;
+            }
+
+            dp::Geo datum_{};
+            CRS crs_ = CRS::ENU;
+            bool localize_ = true;
+            FeatureFilter filter_;
+            std::shared_ptr<const void> source_;
+
+            std::vector<Node> nodes_;
+            std::vector<dp::Point> points_;
+            std::vector<Geometry> geometries_;
+            std::string key_;
+            size_t property_hint_ = 0;
+            std::unordered_map<std::string, PropertyKey, TextHash, std::equal_to<>> keys_;
+
+            std::vector<std::vector<dp::Point>> spare_paths_;
+            std::vector<dp::Polygon> spare_polygons_;
+            std::vector<std::shared_ptr<PropertyMap>> spare_maps_;
+        };
+
+        // Stretch of a 'features' array decoded on its own. 'begin' is where its first element is
+        // believed to start and 'next' is where decoding stopped: the start of the first element at or
+        // past 'stop', or just past the closing ']' if the array ended first.
+        struct FeatureChunk {
+            const char *begin = nullptr;
+            const char *stop = nullptr;
+            const char *next = nullptr;
+            bool closed = false;
+            std::vector<Feature> features;
+            std::exception_ptr error;
+        };
+
+        inline void decode_chunk(FeatureDecoder &decoder, const char *text_end, FeatureChunk &chunk,
+                                 std::vector<Feature> &out) {
+            Cursor c(chunk.begin, text_end);
+            chunk.closed = false;
+            for (;;) {
+                decoder.decode(c, out);
+                if (c.consume(',')) {
+                    c.peek();
+                    if (c.position() >= chunk.stop)
+                        break;
+                    continue;
+                }
+                c.expect(']', "expected ',' or ']'");
+                chunk.closed = true;
+                break;
+            }
+            chunk.next = c.position();
+        }
+
+        // First likely element start at or after p: a '{' that follows a ',' and opens an object with a
+        // key. Nested objects and string contents can fool it; that only costs a serial re-decode.
+        inline const char *guess_element(const char *p, const char *end) {
+            for (; p < end; ++p) {
+                if (*p != ',')
+                    continue;
+                const char *q = scan::skip_ws(p + 1, end);
+                if (q == end || *q != '{')
+                    continue;
+                const char *k = scan::skip_ws(q + 1, end);
+                if (k < end && *k == '"')
+                    return q;
+            }
+            return end;
+        }
+
+        // Below this many bytes per chunk, threads cost more than they save
+        constexpr size_t min_parallel_chunk = size_t(1) << 16;
+
+        // Decodes the 'features' array at c into out, on up to 'threads' threads. The array is cut at
+        // guessed element starts and the chunks are decoded speculatively; a guess is only trusted if
+        // the chunk before it, decoding from a confirmed start, stops exactly there. Stretches after a
+        // wrong guess are decoded again serially, so the features, their order and the first error
+        // thrown are always those of a plain front-to-back read.
+        inline void decode_feature_array(Cursor &c, FeatureDecoder &decoder, size_t threads,
+                                         std::vector<Feature> &out) {
+            if (c.peek() != '[') {
+                c.skip();
+                return;
+            }
+            c.consume('[');
+            if (c.consume(']'))
+                return;
+
+            c.peek();
+            const char *first = c.position();
+            const char *end = c.end();
+            size_t bytes = static_cast<size_t>(end - first);
+            threads = resolve_threads(threads);
+            size_t wanted = threads > 1 ? std::min(threads * 4, bytes / min_parallel_chunk) : 1;
+            if (wanted <= 1) {
+                FeatureChunk all;
+                all.begin = first;
+                all.stop = end;
+                decode_chunk(decoder, end, all, out);
+                c.seek(all.next);
+                return;
+            }
+
+            std::vector<FeatureChunk> chunks(1);
+            chunks[0].begin = first;
+            for (size_t k = 1; k < wanted; ++k) {
+                const char *guess = guess_element(first + bytes / wanted * k, end);
+                if (guess == end)
+                    break;
+                if (guess > chunks.back().begin) {
+                    chunks.emplace_back();
+                    chunks.back().begin = guess;
+                }
+            }
+            for (size_t k = 0; k < chunks.size(); ++k)
+                chunks[k].stop = k + 1 < chunks.size() ? chunks[k + 1].begin : end;
+
+            if (chunks.size() == 1) {
+                decode_chunk(decoder, end, chunks[0], out);
+                c.seek(chunks[0].next);
+                return;
+            }
+
+            parallel_for(chunks.size(), threads, [&](size_t k) {
+                FeatureDecoder local = decoder.fork();
+                try {
+                    decode_chunk(local, end, chunks[k], chunks[k].features);
+                } catch (...) {
+                    chunks[k].error = std::current_exception(); // only an error if the chunk is confirmed
+                }
+            });
+
+            size_t total = 0;
+            for (const auto &chunk : chunks)
+                total += chunk.features.size();
+            out.reserve(out.size() + total);
+
+            const char *pos = first;
+            for (auto &chunk : chunks) {
+                if (chunk.begin == pos) {
+                    if (chunk.error)
+                        std::rethrow_exception(chunk.error);
+                    std::move(chunk.features.begin(), chunk.features.end(), std::back_inserter(out));
+                } else {
+                    chunk.begin = pos;
+                    decode_chunk(decoder, end, chunk, out);
+                }
+                pos = chunk.next;
+                if (chunk.closed)
+                    break;
+            }
+            c.seek(pos);
+        }
+    } // namespace detail
+
+} // namespace vectkit
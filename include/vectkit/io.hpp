@@ -0,0 +1,276 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace vectkit {
+
+    namespace detail {
+        // Read-only view of a whole input file. Regular files are mapped so the parser works straight
+        // off the page cache instead of copying the file into the heap first; anything that cannot be
+        // mapped (pipes, character devices, procfs entries) is read into an owned buffer instead.
+        class MappedFile {
+          public:
+            MappedFile() = default;
+            explicit MappedFile(const std::filesystem::path &file) { open(file); }
+            ~MappedFile() { close(); }
+
+            MappedFile(const MappedFile &) = delete;
+            MappedFile &operator=(const MappedFile &) = delete;
+
+            MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+            MappedFile &operator=(MappedFile &&other) noexcept {
+                if (this != &other) {
+                    close();
+                    map_ = std::exchange(other.map_, nullptr);
+                    size_ = std::exchange(other.size_, 0);
+                    open_ = std::exchange(other.open_, false);
+                    fallback_ = std::move(other.fallback_);
+                }
+                return *this;
+            }
+
+            // Returns false if the file cannot be opened or read; the caller decides how to report it
+            bool open(const std::filesystem::path &file) {
+                close();
+
+                int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0)
+                    return false;
+
+                struct stat st {};
+                if (::fstat(fd, &st) != 0) {
+                    ::close(fd);
+                    return false;
+                }
+
+                bool ok = S_ISREG(st.st_mode) ? map(fd, static_cast<size_t>(st.st_size)) : slurp(fd);
+                ::close(fd);
+                open_ = ok;
+                return ok;
+            }
+
+            void close() {
+                if (map_)
+                    ::munmap(map_, size_);
+                map_ = nullptr;
+                size_ = 0;
+                open_ = false;
+                fallback_.clear();
+            }
+
+            bool is_open() const { return open_; }
+
+            const char *data() const {
+                if (map_)
+                    return static_cast<const char *>(map_);
+                return fallback_.data();
+            }
+
+            size_t size() const { return map_ ? size_ : fallback_.size(); }
+
+            std::string_view view() const { return {data(), size()}; }
+
+          private:
+            bool map(int fd, size_t size) {
+                if (size == 0)
+                    return true; // mmap rejects empty ranges; an empty view parses (and fails) like any input
+
+                void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED)
+                    return slurp(fd);
+
+                // The parsers walk the input front to back exactly once
+                ::madvise(p, size, MADV_SEQUENTIAL);
+                map_ = p;
+                size_ = size;
+                return true;
+            }
+
+            bool slurp(int fd) {
+                char chunk[1 << 16];
+                for (;;) {
+                    ssize_t n = ::read(fd, chunk, sizeof(chunk));
+                    if (n == 0)
+                        return true;
+                    if (n < 0) {
+                        if (errno == EINTR)
+                            continue;
+                        fallback_.clear();
+                        return false;
+                    }
+                    fallback_.append(chunk, static_cast<size_t>(n));
+                }
+            }
+
+            void *map_ = nullptr;
+            size_t size_ = 0;
+            bool open_ = false;
+            std::string fallback_;
+        };
+
+        // Pull-based byte source for readers that keep only a bounded window of the input in memory
+        class InputSource {
+          public:
+            virtual ~InputSource() = default;
+
+            // Reads up to n bytes into dst; returns 0 at end of input
+            virtual size_t read(char *dst, size_t n) = 0;
+
+            // Restarts from the first byte; returns false if the source cannot go back
+            virtual bool rewind() { return false; }
+        };
+
+        class FileSource : public InputSource {
+          public:
+            FileSource() = default;
+            FileSource(const FileSource &) = delete;
+            FileSource &operator=(const FileSource &) = delete;
+            ~FileSource() override {
+                if (fd_ >= 0)
+                    ::close(fd_);
+            }
+
+            bool open(const std::filesystem::path &file) {
+                fd_ = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd_ < 0)
+                    return false;
+                ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+                return true;
+            }
+
+            size_t read(char *dst, size_t n) override {
+                for (;;) {
+                    ssize_t got = ::read(fd_, dst, n);
+                    if (got >= 0)
+                        return static_cast<size_t>(got);
+                    if (errno != EINTR)
+                        throw std::runtime_error("read failed: " + std::string(std::strerror(errno)));
+                }
+            }
+
+            bool rewind() override { return ::lseek(fd_, 0, SEEK_SET) == 0; }
+
+          private:
+            int fd_ = -1;
+        };
+
+        // Writes all of data to fd, however many write calls that takes
+        inline void write_fd(int fd, std::string_view data) {
+            while (!data.empty()) {
+                ssize_t n = ::write(fd, data.data(), data.size());
+                if (n < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::runtime_error("write failed: " + std::string(std::strerror(errno)));
+                }
+                data.remove_prefix(static_cast<size_t>(n));
+            }
+        }
+
+        // Push-based byte sink for writers that hand their output over in large chunks
+        class OutputSink {
+          public:
+            virtual ~OutputSink() = default;
+
+            virtual void write(std::string_view data) = 0;
+
+            // Writes parts back to back
+            virtual void write_parts(std::span<const std::string> parts) {
+                for (const auto &part : parts)
+                    write(part);
+            }
+        };
+
+        class StreamSink : public OutputSink {
+          public:
+            explicit StreamSink(std::ostream &os) : os_(os) {}
+
+            void write(std::string_view data) override {
+                if (!os_.write(data.data(), static_cast<std::streamsize>(data.size())))
+                    throw std::runtime_error("write failed");
+            }
+
+          private:
+            std::ostream &os_;
+        };
+
+        // Writes straight to a file descriptor, without a stream buffer copying every chunk on the way
+        class FileSink : public OutputSink {
+          public:
+            FileSink() = default;
+            FileSink(const FileSink &) = delete;
+            FileSink &operator=(const FileSink &) = delete;
+            ~FileSink() override {
+                if (fd_ >= 0)
+                    ::close(fd_);
+            }
+
+            // Creates or truncates file; returns false if it cannot be opened
+            bool open(const std::filesystem::path &file) {
+                fd_ = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+                return fd_ >= 0;
+            }
+
+            void write(std::string_view data) override { write_fd(fd_, data); }
+
+            // One writev per batch of parts, so separately built buffers reach the file without first
+            // being copied into one
+            void write_parts(std::span<const std::string> parts) override {
+                constexpr int max_iov = 64;
+                size_t i = 0, done = 0; // parts[i] is written up to 'done'
+                for (;;) {
+                    iovec iov[max_iov];
+                    int n = 0;
+                    for (size_t j = i; j < parts.size() && n < max_iov; ++j) {
+                        size_t from = j == i ? done : 0;
+                        if (parts[j].size() > from)
+                            iov[n++] = iovec{const_cast<char *>(parts[j].data()) + from, parts[j].size() - from};
+                    }
+                    if (n == 0)
+                        return;
+                    ssize_t wrote = ::writev(fd_, iov, n);
+                    if (wrote < 0) {
+                        if (errno == EINTR)
+                            continue;
+                        throw std::runtime_error("write failed: " + std::string(std::strerror(errno)));
+                    }
+                    size_t left = static_cast<size_t>(wrote);
+                    while (i < parts.size() && left >= parts[i].size() - done) {
+                        left -= parts[i].size() - done;
+                        ++i;
+                        done = 0;
+                    }
+                    done += left;
+                }
+            }
+
+            // Closing can report a write the kernel deferred (e.g. on NFS), so it is checked too
+            void close() {
+                if (fd_ < 0)
+                    return;
+                int fd = std::exchange(fd_, -1);
+                if (::close(fd) != 0)
+                    throw std::runtime_error("write failed: " + std::string(std::strerror(errno)));
+            }
+
+          private:
+            int fd_ = -1;
+        };
+    } // namespace detail
+
+} // namespace vectkit
@@ -1,22 +1,77 @@
 #pragma once
 
 #include "json.hpp"
+#include "vectkit/compress.hpp"
+#include "vectkit/decode.hpp"
+#include "vectkit/io.hpp"
+#include "vectkit/scan.hpp"
 #include "vectkit/types.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
-#include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
-#include <sstream>
+#include <optional>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 #include <vector>
 
 namespace vectkit {
 
+    // Area a read is limited to, as a ring of vertices (the first one is not repeated at the end). x/y
+    // are longitude/latitude for WGS and east/north for ENU; z is ignored.
+    struct Region {
+        CRS crs = CRS::ENU;
+        std::vector<dp::Point> boundary;
+
+        static Region box(CRS crs, double min_x, double min_y, double max_x, double max_y) {
+            return Region{crs, {dp::Point{min_x, min_y, 0.0}, dp::Point{max_x, min_y, 0.0},
+                                dp::Point{max_x, max_y, 0.0}, dp::Point{min_x, max_y, 0.0}}};
+        }
+    };
+
+    struct ReadOptions {
+        // Threads decoding features (0 = one per hardware thread). The result is the same for any value.
+        size_t threads = 1;
+
+        // Property keys to keep on each feature; unset keeps them all. Global properties are unaffected.
+        std::optional<std::vector<std::string>> properties{};
+
+        // Only features whose properties (all of them, before the projection above) pass are read. It
+        // runs before the feature's geometry is decoded or converted, on the reading thread(s). With
+        // threads other than 1 it must be thread-safe and free of side effects: the features array is
+        // cut at guessed feature starts, so a chunk that started at a wrong guess calls it on property
+        // sets that are not real features, and again on the same features when that chunk is re-read.
+        std::function<bool(const Properties::Map &)> filter{};
+
+        // Only geometries of these types are read; empty reads every type. Multi* types are matched as
+        // written, before they are split, and GeometryCollection members are matched one by one.
+        std::vector<GeometryType> geometry_types{};
+
+        // Features that cannot reach this region are dropped, tested on their raw coordinates before
+        // any point is converted to ENU. The test uses each geometry's bounding box, so features just
+        // outside the region may remain; Multi* parts are tested one by one.
+        std::optional<Region> region{};
+
+        // Keep MultiPoint, MultiLineString and MultiPolygon geometries as one feature each (MultiPoint,
+        // MultiLineString, MultiPolygon) and polygons with holes as PolygonWithHoles, instead of one feature
+        // per part with the inner rings dropped. Parts are then tested against the region as a whole.
+        bool keep_multipart = false;
+
+        // Keep each feature's properties as raw JSON until they are first accessed, instead of decoding
+        // them all up front. The features keep the input alive: a mapped file stays mapped, and an
+        // in-memory buffer is copied once, until every set has been decoded or dropped. Ignored when
+        // 'properties' or 'filter' is given, which need the values while reading.
+        bool lazy_properties = false;
+    };
+
     namespace detail {
         // RAII wrapper for json_value_s to ensure proper cleanup
         struct JsonDeleter {
@@ -27,6 +82,67 @@ namespace vectkit {
         };
         using JsonPtr = std::unique_ptr<json_value_s, JsonDeleter>;
 
+        // The cause json.hpp gives for a failed parse
+        inline const char *json_error_text(size_t error) {
+            switch (error) {
+            case json_parse_error_expected_comma_or_closing_bracket:
+                return "expected ',' or closing bracket";
+            case json_parse_error_expected_colon:
+                return "expected ':'";
+            case json_parse_error_expected_opening_quote:
+                return "expected '\"'";
+            case json_parse_error_invalid_string_escape_sequence:
+                return "invalid escape";
+            case json_parse_error_invalid_number_format:
+                return "invalid number";
+            case json_parse_error_invalid_value:
+                return "invalid value";
+            case json_parse_error_premature_end_of_buffer:
+                return "unexpected end of input";
+            case json_parse_error_invalid_string:
+                return "invalid string";
+            case json_parse_error_allocator_failed:
+                return "out of memory";
+            case json_parse_error_unexpected_trailing_characters:
+                return "unexpected trailing characters";
+            case json_parse_error_recursion:
+                return "nesting too deep";
+            default:
+                return "invalid JSON";
+            }
+        }
+
+        // Backing store for json_parse_ex. json.hpp makes exactly one allocation per parse, so the arena
+        // hands out the same block every time and only grows it when a parse needs more. A DOM parsed
+        // into it is valid until the next parse.
+        class JsonArena {
+          public:
+            // The DOM of text. Throws scan::ParseError naming 'what', the cause and the offset in text.
+            json_value_s *parse(std::string_view text, const char *what) {
+                json_parse_result_s result{};
+                json_value_s *value = json_parse_ex(text.data(), text.size(), json_parse_flags_default,
+                                                    &JsonArena::allocate, this, &result);
+                if (!value)
+                    throw scan::ParseError(std::string(what) + ": " + json_error_text(result.error) + " at offset " +
+                                           std::to_string(result.error_offset));
+                return value;
+            }
+
+          private:
+            static void *allocate(void *self, size_t size) {
+                auto &arena = *static_cast<JsonArena *>(self);
+                size_t blocks = (size + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+                if (blocks > arena.blocks_) {
+                    arena.block_ = std::make_unique<std::max_align_t[]>(blocks);
+                    arena.blocks_ = blocks;
+                }
+                return arena.block_.get();
+            }
+
+            std::unique_ptr<std::max_align_t[]> block_;
+            size_t blocks_ = 0;
+        };
+
         // Helper to find an element in a JSON object by key
         inline json_object_element_s *find_element(json_object_s *obj, const char *key) {
             if (!obj)
@@ -52,7 +168,7 @@ namespace vectkit {
             if (!val || val->type != json_type_number)
                 return 0.0;
             auto *num = static_cast<json_number_s *>(val->payload);
-            return std::stod(std::string(num->number, num->number_size));
+            return scan::parse_number(num->number, num->number_size);
         }
 
         // Helper to get an object from a JSON value
@@ -76,8 +192,12 @@ namespace vectkit {
 
             switch (val->type) {
             case json_type_string: {
+                // The DOM holds strings unescaped
                 auto *str = static_cast<json_string_s *>(val->payload);
-                return "\"" + std::string(str->string, str->string_size) + "\"";
+                std::string result = "\"";
+                append_escaped(result, std::string_view(str->string, str->string_size));
+                result += '"';
+                return result;
             }
             case json_type_number: {
                 auto *num = static_cast<json_number_s *>(val->payload);
@@ -97,7 +217,9 @@ namespace vectkit {
                     if (!first)
                         result += ",";
                     first = false;
-                    result += "\"" + std::string(elem->name->string, elem->name->string_size) + "\":";
+                    result += '"';
+                    append_escaped(result, std::string_view(elem->name->string, elem->name->string_size));
+                    result += "\":";
                     result += serialize_value(elem->value);
                 }
                 result += "}";
@@ -121,298 +243,433 @@ namespace vectkit {
             }
         }
 
-        inline JsonPtr read_json_file(const std::filesystem::path &file) {
-            std::ifstream ifs(file);
-            if (!ifs) {
-                throw std::runtime_error("vectkit::ReadFeatureCollection(): cannot open \"" + file.string() + '\"');
+        // A DOM value as a typed property value, with the same types a feature property gets
+        inline PropertyValue property_value(json_value_s *val) {
+            switch (val->type) {
+            case json_type_string:
+                return PropertyValue(get_string(val));
+            case json_type_number: {
+                auto *num = static_cast<json_number_s *>(val->payload);
+                return PropertyValue::number(std::string_view(num->number, num->number_size));
             }
-
-            std::stringstream buffer;
-            buffer << ifs.rdbuf();
-            std::string content = buffer.str();
-
-            json_value_s *root = json_parse(content.c_str(), content.size());
-            if (!root) {
-                throw std::runtime_error("vectkit::ReadFeatureCollection(): failed to parse JSON");
+            case json_type_true:
+                return PropertyValue(true);
+            case json_type_false:
+                return PropertyValue(false);
+            case json_type_null:
+                return PropertyValue();
+            default:
+                return PropertyValue::raw(serialize_value(val));
             }
+        }
 
-            JsonPtr j(root);
-
-            auto *obj = get_object(j.get());
-            if (!obj) {
-                throw std::runtime_error(
-                    "vectkit::ReadFeatureCollection(): top-level object has no string 'type' field");
-            }
+        inline vectkit::CRS parse_crs(const std::string &s) {
+            if (s == "EPSG:4326" || s == "WGS84" || s == "WGS")
+                return vectkit::CRS::WGS;
+            else if (s == "ENU" || s == "ECEF")
+                return vectkit::CRS::ENU;
+            throw std::runtime_error("Unknown CRS string: " + s);
+        }
 
-            auto *type_elem = find_element(obj, "type");
-            if (!type_elem || type_elem->value->type != json_type_string) {
-                throw std::runtime_error(
-                    "vectkit::ReadFeatureCollection(): top-level object has no string 'type' field");
+        // Reads crs, datum and heading from a collection's top-level 'properties' value into fc, keeps
+        // every other key as a global property, and returns the CRS the coordinates are given in
+        inline vectkit::CRS parse_header(json_value_s *props_val, FeatureCollection &fc) {
+            if (!props_val || props_val->type != json_type_object)
+                throw std::runtime_error("missing top-level 'properties'");
+
+            auto *P = get_object(props_val);
+
+            auto *crs_elem = find_element(P, "crs");
+            if (!crs_elem || crs_elem->value->type != json_type_string)
+                throw std::runtime_error("'properties' missing string 'crs'");
+
+            auto *datum_elem = find_element(P, "datum");
+            auto *datum_arr = datum_elem ? get_array(datum_elem->value) : nullptr;
+            if (!datum_arr || datum_arr->length < 3)
+                throw std::runtime_error("'properties' missing array 'datum' of ≥3 numbers");
+
+            auto *heading_elem = find_element(P, "heading");
+            if (!heading_elem || heading_elem->value->type != json_type_number)
+                throw std::runtime_error("'properties' missing numeric 'heading'");
+
+            auto crsVal = parse_crs(get_string(crs_elem->value));
+
+            // Parse datum array - GeoJSON uses [longitude, latitude, altitude] order
+            auto *d0 = datum_arr->start;
+            auto *d1 = d0->next;
+            auto *d2 = d1->next;
+            double lon = get_number(d0->value);
+            double lat = get_number(d1->value);
+            double alt = get_number(d2->value);
+            fc.datum = dp::Geo{lat, lon, alt}; // dp::Geo stores as {latitude, longitude, altitude}
+
+            double yaw = get_number(heading_elem->value);
+            fc.heading = dp::Euler{0.0, 0.0, yaw};
+
+            // Parse global properties (excluding crs, datum, heading) in file order, typed like feature
+            // properties. Clearing keeps the entries of a collection read into before for reuse.
+            fc.global_properties.clear();
+            for (auto *elem = P->start; elem; elem = elem->next) {
+                std::string_view key(elem->name->string, elem->name->string_size);
+                if (key != "crs" && key != "datum" && key != "heading")
+                    fc.global_properties[PropertyKey(key)] = property_value(elem->value);
             }
 
-            std::string type = get_string(type_elem->value);
+            return crsVal;
+        }
 
-            if (type == "FeatureCollection") {
-                return j;
-            }
+        // Reads the header from the raw text of a top-level 'properties' value, or throws the usual
+        // "missing top-level 'properties'" if there was none. The header is small, so it goes through the
+        // DOM and shares parse_header's validation.
+        inline vectkit::CRS decode_header(std::string_view props, bool present, FeatureCollection &fc,
+                                          JsonArena &arena) {
+            if (!present)
+                return parse_header(nullptr, fc);
+            return parse_header(arena.parse(props, "invalid 'properties'"), fc);
+        }
 
-            // For Feature or bare geometry, we need to wrap it - but since json.hpp doesn't
-            // support building JSON, we'll re-parse a constructed string
-            if (type == "Feature") {
-                std::string wrapped = R"({"type":"FeatureCollection","features":[)" + serialize_value(j.get()) + "]}";
-                json_value_s *new_root = json_parse(wrapped.c_str(), wrapped.size());
-                return JsonPtr(new_root);
+        inline FeatureFilter feature_filter(const ReadOptions &options) {
+            FeatureFilter filter;
+            if (options.properties)
+                filter.keep = &*options.properties;
+            if (options.filter)
+                filter.where = &options.filter;
+            if (!options.geometry_types.empty()) {
+                filter.types = 0;
+                for (auto type : options.geometry_types)
+                    filter.types |= std::uint32_t(1) << static_cast<unsigned>(type);
             }
-
-            // Bare geometry - wrap in Feature, then FeatureCollection
-            std::string wrapped = R"({"type":"FeatureCollection","features":[{"type":"Feature","geometry":)" +
-                                  serialize_value(j.get()) + R"(,"properties":{}}]})";
-            json_value_s *new_root = json_parse(wrapped.c_str(), wrapped.size());
-            return JsonPtr(new_root);
+            filter.multipart = options.keep_multipart;
+            return filter;
         }
 
-        inline std::unordered_map<std::string, std::string> parse_properties(json_object_s *props) {
-            std::unordered_map<std::string, std::string> m;
-            if (!props)
-                return m;
-
-            for (auto *elem = props->start; elem; elem = elem->next) {
-                std::string key(elem->name->string, elem->name->string_size);
-                if (elem->value->type == json_type_string) {
-                    m[key] = get_string(elem->value);
-                } else {
-                    m[key] = serialize_value(elem->value);
+        // Puts the region into the frame the coordinates are read in. Edges crossing between WGS and ENU
+        // are subdivided, so the converted ring still covers the region.
+        inline void region_test(const Region &region, const dp::Geo &datum, CRS crs, RegionTest &out) {
+            out.clear();
+            constexpr int steps = 8;
+            const auto &ring = region.boundary;
+            for (size_t i = 0; i < ring.size(); ++i) {
+                const dp::Point &a = ring[i];
+                const dp::Point &b = ring[(i + 1) % ring.size()];
+                int n = region.crs == crs ? 1 : steps;
+                for (int k = 0; k < n; ++k) {
+                    double t = static_cast<double>(k) / n;
+                    double x = a.x + (b.x - a.x) * t;
+                    double y = a.y + (b.y - a.y) * t;
+                    if (region.crs == crs) {
+                        out.add(x, y);
+                    } else if (crs == CRS::ENU) {
+                        auto enu = concord::frame::to_enu(datum, concord::earth::WGS{y, x, datum.altitude});
+                        out.add(enu.east(), enu.north());
+                    } else {
+                        auto wgs = concord::frame::to_wgs(concord::frame::ENU{dp::Point{x, y, 0.0}, datum});
+                        out.add(wgs.longitude, wgs.latitude);
+                    }
                 }
             }
-            return m;
+            out.close();
         }
 
-        inline dp::Point parse_point(json_array_s *coords, const dp::Geo &datum, vectkit::CRS crs) {
-            if (!coords || coords->length < 2) {
-                throw std::runtime_error("Invalid point coordinates");
-            }
+        // Shortest text of a feature, {"type":"Feature","geometry":null,"properties":{}}, so an input can
+        // hold at most size / min_feature_bytes of them
+        constexpr size_t min_feature_bytes = 48;
+
+        // Everything a read needs besides its input and its result, kept together so ParseContext can
+        // carry it from one read to the next
+        struct ParseScratch {
+            JsonArena arena;
+            FeatureDecoder collection;
+            FeatureDecoder single;
+            RegionTest region;
+            size_t feature_hint = 0; // feature count of the previous read, see min_feature_bytes
+            std::string inflated;    // decompressed text of a gzip or zstd input
+        };
 
-            auto *x_elem = coords->start;
-            auto *y_elem = x_elem->next;
-            auto *z_elem = y_elem ? y_elem->next : nullptr;
-
-            double x = get_number(x_elem->value);
-            double y = get_number(y_elem->value);
-            bool has_z = (z_elem != nullptr);
-            double z = has_z ? get_number(z_elem->value) : 0.0;
-
-            if (crs == vectkit::CRS::ENU) {
-                return dp::Point{x, y, z};
-            } else {
-                // For WGS84 input, convert to ENU coordinates
-                // If input has no Z value (2D GeoJSON), use datum altitude to avoid
-                // large Z offsets due to Earth curvature in the ENU frame
-                double wgs_alt = has_z ? z : datum.altitude;
-                concord::earth::WGS wgs{y, x, wgs_alt};
-                auto enu = concord::frame::to_enu(datum, wgs);
-                // For 2D input, set Z to altitude difference from datum (typically 0)
-                double enu_z = has_z ? enu.up() : (z - datum.altitude);
-                return dp::Point{enu.east(), enu.north(), enu_z};
+        // Decodes a whole GeoJSON document in one pass: a FeatureCollection, a single Feature or a bare
+        // geometry. A collection's features are decoded as soon as they are reached if the header has
+        // already been seen; otherwise their text is kept aside and decoded once the datum is known.
+        //
+        // A Feature or bare geometry carries its header (crs, datum, heading) in its own 'properties';
+        // the remaining keys become properties of the features it yields. Its coordinates are read
+        // unlocalized and converted afterwards, so 'properties' may come last without a second parse.
+        //
+        // fc's previous features are handed to the decoder to be rebuilt in place. With a source (lazy
+        // properties), text must lie in memory it keeps alive. Returns the CRS the document is written in.
+        inline CRS decode_document(std::string_view text, const ReadOptions &options, ParseScratch &scratch,
+                                    FeatureCollection &fc, std::shared_ptr<const void> source) {
+            scratch.collection.recycle(fc.features);
+
+            Cursor c(text);
+            if (c.peek() != '{') {
+                c.skip(); // malformed input is reported as such before the missing type
+                throw std::runtime_error(
+                    "vectkit::ReadFeatureCollection(): top-level object has no string 'type' field");
             }
-        }
-
-        inline Geometry parse_line_string(json_array_s *coords, const dp::Geo &datum, vectkit::CRS crs) {
-            std::vector<dp::Point> pts;
-            if (!coords)
-                return pts;
 
-            for (auto *elem = coords->start; elem; elem = elem->next) {
-                auto *pt_arr = get_array(elem->value);
-                if (pt_arr) {
-                    pts.push_back(parse_point(pt_arr, datum, crs));
+            // The previous read's count is only a guess for this input: one context reads unrelated files
+            // in a row, and a small file must not inherit a large one's capacity
+            fc.features.reserve(std::min(scratch.feature_hint, text.size() / min_feature_bytes));
+            CRS crs = CRS::ENU;
+            FeatureDecoder &decoder = scratch.collection;
+            FeatureDecoder &single = scratch.single;
+            decoder.defer_properties(std::move(source));
+            single.reset_unlocalized();
+            FeatureFilter filter = feature_filter(options);
+            single.select(filter);
+
+            // Once the header is known: the region can be put into the file's frame
+            auto start = [&] {
+                if (options.region) {
+                    region_test(*options.region, fc.datum, crs, scratch.region);
+                    filter.region = &scratch.region;
                 }
-            }
-
-            if (pts.size() == 2)
-                return dp::Segment{pts[0], pts[1]};
-            else
-                return pts;
-        }
-
-        inline dp::Polygon parse_polygon(json_array_s *coords, const dp::Geo &datum, vectkit::CRS crs) {
-            std::vector<dp::Point> pts;
-            if (!coords || !coords->start)
-                return dp::Polygon{dp::Vector<dp::Point>{pts.begin(), pts.end()}};
+                decoder.reset(fc.datum, crs);
+                decoder.select(filter);
+            };
+            bool have_type = false;
+            bool have_properties = false;
+            bool have_features = false;
+            bool have_geometry = false;
+            bool have_coords = false;
+            bool have_geometries = false;
+            bool decoded = false;
+            std::optional<std::string_view> type;
+            std::string_view properties, features;
+            std::vector<Geometry> geometry, members;
+            size_t root = FeatureDecoder::no_coordinates;
+
+            c.object([&](std::string_view key) {
+                if (!have_type && scan::key_equals(key, "type")) {
+                    have_type = true;
+                    if (c.peek() == '"')
+                        type = c.string_body();
+                    else
+                        c.skip();
+                } else if (!have_properties && scan::key_equals(key, "properties")) {
+                    have_properties = true;
+                    properties = c.skip();
+                } else if (!have_features && scan::key_equals(key, "features")) {
+                    have_features = true;
+                    if (type && scan::key_equals(*type, "FeatureCollection") && have_properties) {
+                        crs = decode_header(properties, true, fc, scratch.arena);
+                        start();
+                        decode_feature_array(c, decoder, options.threads, fc.features);
+                        decoded = true;
+                    } else {
+                        features = c.skip();
+                    }
+                } else if (!have_geometry && scan::key_equals(key, "geometry")) {
+                    have_geometry = true;
+                    single.read_geometry(c, geometry);
+                } else if (!have_coords && scan::key_equals(key, "coordinates")) {
+                    have_coords = true;
+                    root = single.read_coordinates(c);
+                } else if (!have_geometries && scan::key_equals(key, "geometries")) {
+                    have_geometries = true;
+                    single.read_geometries(c, members);
+                } else {
+                    c.skip();
+                }
+            });
+            if (c.peek() != 0)
+                scan::fail("unexpected trailing characters");
 
-            // Get the first ring (outer ring)
-            auto *ring_arr = get_array(coords->start->value);
-            if (!ring_arr)
-                return dp::Polygon{dp::Vector<dp::Point>{pts.begin(), pts.end()}};
+            if (!type)
+                throw std::runtime_error(
+                    "vectkit::ReadFeatureCollection(): top-level object has no string 'type' field");
 
-            for (auto *elem = ring_arr->start; elem; elem = elem->next) {
-                auto *pt_arr = get_array(elem->value);
-                if (pt_arr) {
-                    pts.push_back(parse_point(pt_arr, datum, crs));
+            if (scan::key_equals(*type, "FeatureCollection")) {
+                if (!decoded) {
+                    crs = decode_header(properties, have_properties, fc, scratch.arena);
+                    start();
+                    if (have_features) {
+                        Cursor fc_cursor(features);
+                        decode_feature_array(fc_cursor, decoder, options.threads, fc.features);
+                    }
                 }
+                scratch.feature_hint = fc.features.size();
+                return crs;
             }
 
-            return dp::Polygon{dp::Vector<dp::Point>{pts.begin(), pts.end()}};
-        }
+            crs = decode_header(properties, have_properties, fc, scratch.arena);
+            fc.global_properties.clear();
+            FeatureDecoder::PropertyMap props;
+            Cursor props_cursor(properties);
+            single.read_properties(props_cursor, props);
+            for (const char *header_key : {"crs", "datum", "heading"})
+                props.erase(header_key);
+            if (!single.accepts(props))
+                return crs;
+            single.project(props);
+
+            if (!scan::key_equals(*type, "Feature")) {
+                GeometryType kind = geometry_type(*type);
+                geometry.clear();
+                if (kind == GeometryType::GeometryCollection)
+                    geometry = std::move(members);
+                else
+                    single.build(kind, root, geometry);
+            }
 
-        inline std::vector<Geometry> parse_geometry(json_object_s *geom, const dp::Geo &datum, vectkit::CRS crs) {
-            std::vector<Geometry> out;
-            if (!geom)
-                return out;
+            if (options.region) {
+                region_test(*options.region, fc.datum, crs, scratch.region);
+                std::erase_if(geometry, [&](const Geometry &g) { return !scratch.region.overlaps(g); });
+            }
 
-            auto *type_elem = find_element(geom, "type");
-            if (!type_elem)
-                return out;
+            fc.features.reserve(geometry.size());
+            Properties shared(std::move(props));
+            for (auto &g : geometry) {
+                localize(g, fc.datum, crs);
+                fc.features.emplace_back(Feature{std::move(g), shared});
+            }
+            return crs;
+        }
+    } // namespace detail
 
-            std::string type = get_string(type_elem->value);
-            auto *coords_elem = find_element(geom, "coordinates");
-            auto *coords = coords_elem ? get_array(coords_elem->value) : nullptr;
+    namespace detail {
+        // 'source' owns text, if anything does. Lazy properties need that, so text owned by the caller is
+        // copied first.
+        inline void read_document(std::string_view text, const ReadOptions &options, ParseScratch &scratch,
+                                  FeatureCollection &fc, std::shared_ptr<const void> source = nullptr) {
+            if (!options.lazy_properties) {
+                source.reset();
+            } else if (!source) {
+                auto copy = std::make_shared<const std::string>(text);
+                text = *copy;
+                source = std::move(copy);
+            }
+            try {
+                decode_document(text, options, scratch, fc, std::move(source));
+            } catch (const scan::ParseError &e) {
+                throw std::runtime_error(std::string("vectkit::ReadFeatureCollection(): failed to parse JSON: ") +
+                                         e.what());
+            }
+        }
 
-            if (type == "Point") {
-                if (coords) {
-                    out.emplace_back(parse_point(coords, datum, crs));
-                }
-            } else if (type == "LineString") {
-                if (coords) {
-                    out.emplace_back(parse_line_string(coords, datum, crs));
-                }
-            } else if (type == "Polygon") {
-                if (coords) {
-                    out.emplace_back(parse_polygon(coords, datum, crs));
-                }
-            } else if (type == "MultiPoint") {
-                if (coords) {
-                    for (auto *elem = coords->start; elem; elem = elem->next) {
-                        auto *pt_arr = get_array(elem->value);
-                        if (pt_arr) {
-                            out.emplace_back(parse_point(pt_arr, datum, crs));
-                        }
-                    }
-                }
-            } else if (type == "MultiLineString") {
-                if (coords) {
-                    for (auto *elem = coords->start; elem; elem = elem->next) {
-                        auto *line_arr = get_array(elem->value);
-                        if (line_arr) {
-                            out.emplace_back(parse_line_string(line_arr, datum, crs));
-                        }
-                    }
+        // Hands the text of file to read(text, source), decoded straight from the mapped pages; features
+        // own copies of everything they need, so the mapping is released on return. Lazy properties take
+        // the mapping over instead, as 'source'.
+        //
+        // A gzip or zstd file is decompressed from the mapping into scratch.inflated first, whatever its
+        // name; the document parser needs the whole text, so FeatureReader is the way to read a large
+        // compressed file in bounded memory.
+        template <typename Read>
+        void read_file_text(const std::filesystem::path &file, const char *who, const ReadOptions &options,
+                            ParseScratch &scratch, MappedFile &input, Read &&read) {
+            if (!input.open(file)) {
+                throw std::runtime_error(std::string(who) + ": cannot open \"" + file.string() + '\"');
+            }
+            if (Compression c = sniff_compression(input.view()); c != Compression::None) {
+                {
+                    struct Close {
+                        MappedFile &f;
+                        ~Close() { f.close(); }
+                    } close{input};
+                    decompress(input.view(), c, scratch.inflated, std::string(who) + ": \"" + file.string() + '\"');
                 }
-            } else if (type == "MultiPolygon") {
-                if (coords) {
-                    for (auto *elem = coords->start; elem; elem = elem->next) {
-                        auto *poly_arr = get_array(elem->value);
-                        if (poly_arr) {
-                            out.emplace_back(parse_polygon(poly_arr, datum, crs));
-                        }
-                    }
-                }
-            } else if (type == "GeometryCollection") {
-                auto *geoms_elem = find_element(geom, "geometries");
-                auto *geoms_arr = geoms_elem ? get_array(geoms_elem->value) : nullptr;
-                if (geoms_arr) {
-                    for (auto *elem = geoms_arr->start; elem; elem = elem->next) {
-                        auto *sub_obj = get_object(elem->value);
-                        if (sub_obj) {
-                            auto subs = parse_geometry(sub_obj, datum, crs);
-                            out.insert(out.end(), subs.begin(), subs.end());
-                        }
-                    }
+                if (options.lazy_properties) {
+                    auto text = std::make_shared<const std::string>(std::move(scratch.inflated));
+                    read(std::string_view(*text), text);
+                    return;
                 }
+                read(std::string_view(scratch.inflated), nullptr);
+                return;
+            }
+            if (options.lazy_properties) {
+                auto mapped = std::make_shared<const MappedFile>(std::move(input));
+                read(mapped->view(), mapped);
+                return;
             }
-            return out;
+            struct Close {
+                MappedFile &f;
+                ~Close() { f.close(); }
+            } close{input};
+            read(input.view(), nullptr);
         }
 
-        inline vectkit::CRS parse_crs(const std::string &s) {
-            if (s == "EPSG:4326" || s == "WGS84" || s == "WGS")
-                return vectkit::CRS::WGS;
-            else if (s == "ENU" || s == "ECEF")
-                return vectkit::CRS::ENU;
-            throw std::runtime_error("Unknown CRS string: " + s);
+        inline void read_file(const std::filesystem::path &file, const ReadOptions &options, ParseScratch &scratch,
+                              MappedFile &input, FeatureCollection &fc) {
+            read_file_text(file, "vectkit::ReadFeatureCollection()", options, scratch, input,
+                           [&](std::string_view text, std::shared_ptr<const void> source) {
+                               read_document(text, options, scratch, fc, std::move(source));
+                           });
         }
     } // namespace detail
 
-    inline FeatureCollection ReadFeatureCollection(const std::filesystem::path &file) {
-        auto fc_json = detail::read_json_file(file);
-        auto *fc_obj = detail::get_object(fc_json.get());
-
-        auto *props_elem = detail::find_element(fc_obj, "properties");
-        if (!props_elem || props_elem->value->type != json_type_object)
-            throw std::runtime_error("missing top-level 'properties'");
-
-        auto *P = detail::get_object(props_elem->value);
+    inline FeatureCollection ReadFeatureCollection(const std::filesystem::path &file,
+                                                   const ReadOptions &options = {}) {
+        FeatureCollection fc;
+        detail::ParseScratch scratch;
+        detail::MappedFile input;
+        detail::read_file(file, options, scratch, input, fc);
+        return fc;
+    }
 
-        auto *crs_elem = detail::find_element(P, "crs");
-        if (!crs_elem || crs_elem->value->type != json_type_string)
-            throw std::runtime_error("'properties' missing string 'crs'");
+    // Re-reads a file into an existing collection, e.g. one reloaded at a fixed rate. fc's features are
+    // rebuilt in place: point buffers, property maps and the feature vector keep their capacity and
+    // only grow when the new data needs more. On error fc is left valid but with unspecified contents.
+    inline void read_into(const std::filesystem::path &file, FeatureCollection &fc, const ReadOptions &options = {}) {
+        detail::ParseScratch scratch;
+        detail::MappedFile input;
+        detail::read_file(file, options, scratch, input, fc);
+    }
 
-        auto *datum_elem = detail::find_element(P, "datum");
-        auto *datum_arr = datum_elem ? detail::get_array(datum_elem->value) : nullptr;
-        if (!datum_arr || datum_arr->length < 3)
-            throw std::runtime_error("'properties' missing array 'datum' of ≥3 numbers");
+    // Parses a GeoJSON document held in memory (e.g. received over IPC or HTTP) in place, without
+    // copying it. The text only has to outlive the call.
+    inline FeatureCollection read_from_buffer(std::string_view text, const ReadOptions &options = {}) {
+        FeatureCollection fc;
+        detail::ParseScratch scratch;
+        detail::read_document(text, options, scratch, fc);
+        return fc;
+    }
 
-        auto *heading_elem = detail::find_element(P, "heading");
-        if (!heading_elem || heading_elem->value->type != json_type_number)
-            throw std::runtime_error("'properties' missing numeric 'heading'");
+    inline FeatureCollection read_from_buffer(std::span<const char> bytes, const ReadOptions &options = {}) {
+        return read_from_buffer(std::string_view(bytes.data(), bytes.size()), options);
+    }
 
-        auto crsVal = detail::parse_crs(detail::get_string(crs_elem->value));
+    // Both of the above accept these; spell them out so the calls are not ambiguous
+    inline FeatureCollection read_from_buffer(const std::string &text, const ReadOptions &options = {}) {
+        return read_from_buffer(std::string_view(text), options);
+    }
 
-        // Parse datum array - GeoJSON uses [longitude, latitude, altitude] order
-        auto *d0 = datum_arr->start;
-        auto *d1 = d0->next;
-        auto *d2 = d1->next;
-        double lon = detail::get_number(d0->value);
-        double lat = detail::get_number(d1->value);
-        double alt = detail::get_number(d2->value);
-        dp::Geo d{lat, lon, alt}; // dp::Geo stores as {latitude, longitude, altitude}
+    inline FeatureCollection read_from_buffer(const char *text, const ReadOptions &options = {}) {
+        return read_from_buffer(std::string_view(text), options);
+    }
 
-        double yaw = detail::get_number(heading_elem->value);
-        dp::Euler euler{0.0, 0.0, yaw};
+    // Reusable state for reading many files in a row: the arena behind the header DOM, the decoder's
+    // scratch buffers and the read buffer for inputs that cannot be mapped. Once these have grown to
+    // fit the inputs, a read only allocates what the returned FeatureCollection itself holds (threaded
+    // reads still set up per-chunk buffers). Use one context per thread.
+    //
+    // Combined with the *_into calls, which rebuild an existing collection in place, steady-state
+    // reloads of similarly shaped data do not allocate at all.
+    class ParseContext {
+      public:
+        FeatureCollection read(const std::filesystem::path &file, const ReadOptions &options = {}) {
+            FeatureCollection fc;
+            read_into(file, fc, options);
+            return fc;
+        }
 
-        FeatureCollection fc;
-        fc.datum = d;
-        fc.heading = euler;
-
-        // Parse global properties (excluding crs, datum, heading)
-        for (auto *elem = P->start; elem; elem = elem->next) {
-            std::string key(elem->name->string, elem->name->string_size);
-            if (key != "crs" && key != "datum" && key != "heading") {
-                if (elem->value->type == json_type_string) {
-                    fc.global_properties[key] = detail::get_string(elem->value);
-                } else {
-                    fc.global_properties[key] = detail::serialize_value(elem->value);
-                }
-            }
+        FeatureCollection read_from_buffer(std::string_view text, const ReadOptions &options = {}) {
+            FeatureCollection fc;
+            read_from_buffer_into(text, fc, options);
+            return fc;
         }
 
-        // Parse features
-        auto *features_elem = detail::find_element(fc_obj, "features");
-        auto *features_arr = features_elem ? detail::get_array(features_elem->value) : nullptr;
-        if (features_arr) {
-            for (auto *feat_elem = features_arr->start; feat_elem; feat_elem = feat_elem->next) {
-                auto *feat_obj = detail::get_object(feat_elem->value);
-                if (!feat_obj)
-                    continue;
-
-                auto *geom_elem = detail::find_element(feat_obj, "geometry");
-                if (!geom_elem || geom_elem->value->type == json_type_null)
-                    continue;
-
-                auto *geom_obj = detail::get_object(geom_elem->value);
-                auto geoms = detail::parse_geometry(geom_obj, d, crsVal);
-
-                std::unordered_map<std::string, std::string> props_map;
-                auto *feat_props_elem = detail::find_element(feat_obj, "properties");
-                if (feat_props_elem && feat_props_elem->value->type == json_type_object) {
-                    props_map = detail::parse_properties(detail::get_object(feat_props_elem->value));
-                }
+        void read_into(const std::filesystem::path &file, FeatureCollection &fc, const ReadOptions &options = {}) {
+            detail::read_file(file, options, scratch_, input_, fc);
+        }
 
-                for (auto &g : geoms)
-                    fc.features.emplace_back(Feature{std::move(g), props_map});
-            }
+        void read_from_buffer_into(std::string_view text, FeatureCollection &fc, const ReadOptions &options = {}) {
+            detail::read_document(text, options, scratch_, fc);
         }
 
-        return fc;
-    }
+      private:
+        detail::ParseScratch scratch_;
+        detail::MappedFile input_;
+    };
 
     inline std::ostream &operator<<(std::ostream &os, FeatureCollection const &fc) {
         os << "DATUM: " << fc.datum.latitude << ", " << fc.datum.longitude << ", " << fc.datum.altitude << "\n"
@@ -429,6 +686,14 @@ namespace vectkit {
                 os << "  PATH\n";
             } else if (std::get_if<dp::Point>(&v)) {
                 os << "   POINT\n";
+            } else if (std::get_if<MultiPoint>(&v)) {
+                os << "  MULTIPOINT\n";
+            } else if (std::get_if<MultiLineString>(&v)) {
+                os << "  MULTILINE\n";
+            } else if (std::get_if<PolygonWithHoles>(&v)) {
+                os << "  POLYGON (HOLES)\n";
+            } else if (std::get_if<MultiPolygon>(&v)) {
+                os << "  MULTIPOLYGON\n";
             }
             if (f.properties.size() > 0)
                 os << "    PROPS:" << f.properties.size() << "\n";
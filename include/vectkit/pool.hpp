@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace vectkit {
+
+    namespace detail {
+        // 0 means one thread per hardware thread
+        inline size_t resolve_threads(size_t requested) {
+            if (requested != 0)
+                return requested;
+            return std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        // Runs task(i) for every i in [0, count) on up to 'threads' threads, the calling thread included.
+        // Tasks are handed out in index order as threads become free, so uneven tasks balance out. If
+        // any task throws, the exception of the lowest such index is rethrown once all threads are done.
+        template <typename Task> void parallel_for(size_t count, size_t threads, Task &&task) {
+            threads = std::min(resolve_threads(threads), count);
+            if (threads <= 1) {
+                for (size_t i = 0; i < count; ++i)
+                    task(i);
+                return;
+            }
+
+            std::atomic<size_t> next{0};
+            std::mutex error_mutex;
+            std::exception_ptr error;
+            size_t error_index = count;
+
+            auto work = [&] {
+                for (size_t i = next++; i < count; i = next++) {
+                    try {
+                        task(i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(error_mutex);
+                        if (i < error_index) {
+                            error_index = i;
+                            error = std::current_exception();
+                        }
+                    }
+                }
+            };
+
+            std::vector<std::thread> workers;
+            workers.reserve(threads - 1);
+            for (size_t t = 1; t < threads; ++t)
+                workers.emplace_back(work);
+            work();
+            for (auto &w : workers)
+                w.join();
+
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+        // Threads started once for a series of parallel_for-style runs, e.g. one per batch of a long
+        // write, so no batch pays for starting and joining threads. The workers wait at a barrier
+        // between runs and are joined when the group is destroyed, also when a run or the caller throws.
+        class ThreadGroup {
+          public:
+            explicit ThreadGroup(size_t threads) : sync_(static_cast<std::ptrdiff_t>(std::max<size_t>(threads, 1))) {
+                threads = std::max<size_t>(threads, 1);
+                workers_.reserve(threads - 1);
+                for (size_t t = 1; t < threads; ++t) {
+                    workers_.emplace_back([this] {
+                        for (;;) {
+                            sync_.arrive_and_wait(); // a run is set up, or the group is closing
+                            if (stop_)
+                                return;
+                            work();
+                            sync_.arrive_and_wait(); // every task of the run is done
+                        }
+                    });
+                }
+            }
+
+            ThreadGroup(const ThreadGroup &) = delete;
+            ThreadGroup &operator=(const ThreadGroup &) = delete;
+
+            ~ThreadGroup() {
+                stop_ = true;
+                if (!workers_.empty())
+                    sync_.arrive_and_wait();
+                for (auto &w : workers_)
+                    w.join();
+            }
+
+            // Threads per run, the calling thread included
+            size_t size() const { return workers_.size() + 1; }
+
+            // Same as parallel_for(count, size(), task), on the group's threads
+            template <typename Task> void run(size_t count, Task &&task) {
+                if (workers_.empty() || count <= 1) {
+                    for (size_t i = 0; i < count; ++i)
+                        task(i);
+                    return;
+                }
+                using T = std::remove_reference_t<Task>;
+                task_ = const_cast<void *>(static_cast<const void *>(std::addressof(task)));
+                call_ = [](void *t, size_t i) { (*static_cast<T *>(t))(i); };
+                count_ = count;
+                next_ = 0;
+                error_index_ = count;
+                sync_.arrive_and_wait();
+                work();
+                sync_.arrive_and_wait();
+                if (error_)
+                    std::rethrow_exception(std::exchange(error_, nullptr));
+            }
+
+          private:
+            void work() {
+                for (size_t i = next_++; i < count_; i = next_++) {
+                    try {
+                        call_(task_, i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(error_mutex_);
+                        if (i < error_index_) {
+                            error_index_ = i;
+                            error_ = std::current_exception();
+                        }
+                    }
+                }
+            }
+
+            // Set by the calling thread while the workers wait at the barrier
+            void *task_ = nullptr;
+            void (*call_)(void *, size_t) = nullptr;
+            size_t count_ = 0;
+            bool stop_ = false;
+
+            std::atomic<size_t> next_{0};
+            std::mutex error_mutex_;
+            std::exception_ptr error_;
+            size_t error_index_ = 0;
+            std::barrier<> sync_;
+            std::vector<std::thread> workers_;
+        };
+    } // namespace detail
+
+} // namespace vectkit
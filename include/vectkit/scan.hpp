@@ -0,0 +1,407 @@
+#pragma once
+
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__AVX2__) && !defined(VECTKIT_SIMD_DISABLED)
+#include <immintrin.h>
+#define VECTKIT_SCAN_AVX2 1
+#endif
+
+namespace vectkit {
+
+    namespace detail {
+        // Structural JSON scanning over raw text. These helpers never build a DOM: they find where
+        // values start and end so callers can hand exactly one value at a time to a decoder.
+        //
+        // Every skip_* function takes [p, end) with p on the first byte of the value and returns the
+        // position just past it. They return nullptr when the input ends before the value does, so
+        // windowed readers can refill and retry, and throw scan::ParseError on malformed input.
+        namespace scan {
+#ifdef VECTKIT_SCAN_AVX2
+            // Classifies 32 input bytes at a time; bit i of a mask stands for p[i]. Only used on full
+            // blocks, the last few bytes of a buffer always go through the scalar loops.
+            namespace block {
+                constexpr size_t size = 32;
+
+                inline __m256i load(const char *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+
+                inline __m256i eq(__m256i v, char c) { return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)); }
+
+                inline std::uint32_t mask(__m256i m) { return static_cast<std::uint32_t>(_mm256_movemask_epi8(m)); }
+
+                // Unsigned v <= limit, bytewise
+                inline __m256i at_most(__m256i v, char limit) {
+                    __m256i l = _mm256_set1_epi8(limit);
+                    return _mm256_cmpeq_epi8(_mm256_min_epu8(v, l), v);
+                }
+
+                inline std::uint32_t whitespace(const char *p) {
+                    __m256i v = load(p);
+                    return mask(_mm256_or_si256(_mm256_or_si256(eq(v, ' '), eq(v, '\n')),
+                                                _mm256_or_si256(eq(v, '\r'), eq(v, '\t'))));
+                }
+
+                // Bytes a string scan has to stop at: '"', '\\' and control characters
+                inline std::uint32_t string_special(const char *p) {
+                    __m256i v = load(p);
+                    return mask(_mm256_or_si256(_mm256_or_si256(eq(v, '"'), eq(v, '\\')), at_most(v, 0x1F)));
+                }
+
+                inline std::uint32_t number_chars(const char *p) {
+                    __m256i v = load(p);
+                    __m256i digit = at_most(_mm256_sub_epi8(v, _mm256_set1_epi8('0')), 9);
+                    __m256i sign = _mm256_or_si256(eq(v, '-'), eq(v, '+'));
+                    __m256i rest = _mm256_or_si256(eq(v, '.'), _mm256_or_si256(eq(v, 'e'), eq(v, 'E')));
+                    return mask(_mm256_or_si256(digit, _mm256_or_si256(sign, rest)));
+                }
+            } // namespace block
+#endif
+
+            inline bool is_ws(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+            inline const char *skip_ws(const char *p, const char *end) {
+                // Most calls are already on a token; only indentation runs are worth a vector load
+                if (p < end && !is_ws(*p))
+                    return p;
+#ifdef VECTKIT_SCAN_AVX2
+                while (end - p >= static_cast<std::ptrdiff_t>(block::size)) {
+                    if (std::uint32_t other = ~block::whitespace(p))
+                        return p + std::countr_zero(other);
+                    p += block::size;
+                }
+#endif
+                while (p < end && is_ws(*p))
+                    ++p;
+                return p;
+            }
+
+            // Thrown for syntax errors only, so readers can prefix their own context while letting
+            // semantic errors ("missing top-level 'properties'", ...) through unchanged
+            struct ParseError : std::runtime_error {
+                using std::runtime_error::runtime_error;
+            };
+
+            [[noreturn]] inline void fail(const char *what) { throw ParseError(what); }
+
+            // p is on the opening quote
+            inline const char *skip_string(const char *p, const char *end) {
+                for (++p; p < end; ++p) {
+#ifdef VECTKIT_SCAN_AVX2
+                    // Jump straight to the next byte the loop below has to look at
+                    while (end - p >= static_cast<std::ptrdiff_t>(block::size)) {
+                        if (std::uint32_t special = block::string_special(p)) {
+                            p += std::countr_zero(special);
+                            break;
+                        }
+                        p += block::size;
+                    }
+                    if (p == end)
+                        break;
+#endif
+                    char c = *p;
+                    if (c == '"')
+                        return p + 1;
+                    if (c == '\\') {
+                        if (++p == end)
+                            return nullptr;
+                    } else if (static_cast<unsigned char>(c) < 0x20) {
+                        fail("control character in string");
+                    }
+                }
+                return nullptr;
+            }
+
+            inline bool is_number_char(char c) {
+                return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+            }
+
+            // End of the run of number characters starting at p
+            inline const char *number_end(const char *p, const char *end) {
+#ifdef VECTKIT_SCAN_AVX2
+                while (end - p >= static_cast<std::ptrdiff_t>(block::size)) {
+                    if (std::uint32_t other = ~block::number_chars(p))
+                        return p + std::countr_zero(other);
+                    p += block::size;
+                }
+#endif
+                while (p < end && is_number_char(*p))
+                    ++p;
+                return p;
+            }
+
+            inline const char *skip_number(const char *p, const char *end) {
+                const char *start = p;
+                p = number_end(p, end);
+                if (p == end)
+                    return nullptr; // the number may continue in the next chunk
+                if (p == start)
+                    fail("unexpected character");
+                return p;
+            }
+
+            inline const char *skip_literal(const char *p, const char *end, std::string_view lit) {
+                for (char c : lit) {
+                    if (p == end)
+                        return nullptr;
+                    if (*p++ != c)
+                        fail("invalid literal");
+                }
+                return p;
+            }
+
+            // Same nesting limit as the bundled json.hpp
+            constexpr size_t max_depth = 1000;
+
+            // Containers are skipped iteratively; the stack only records which closer is expected
+            class CloserStack {
+              public:
+                void push_back(char c) {
+                    if (size_ == max_depth)
+                        fail("nesting too deep");
+                    data_[size_++] = c;
+                }
+                void pop_back() { --size_; }
+                char back() const { return data_[size_ - 1]; }
+                bool empty() const { return size_ == 0; }
+
+              private:
+                char data_[max_depth];
+                size_t size_ = 0;
+            };
+
+            inline const char *skip_value(const char *p, const char *end) {
+                CloserStack stack;
+                bool expect_value = true;
+                for (;;) {
+                    p = skip_ws(p, end);
+                    if (p == end)
+                        return nullptr;
+
+                    if (expect_value) {
+                        switch (*p) {
+                        case '{':
+                            stack.push_back('}');
+                            ++p;
+                            p = skip_ws(p, end);
+                            if (p == end)
+                                return nullptr;
+                            if (*p == '}') {
+                                stack.pop_back();
+                                ++p;
+                                expect_value = false;
+                                break;
+                            }
+                            if (*p != '"')
+                                fail("expected object key");
+                            p = skip_string(p, end);
+                            if (!p)
+                                return nullptr;
+                            p = skip_ws(p, end);
+                            if (p == end)
+                                return nullptr;
+                            if (*p++ != ':')
+                                fail("expected ':'");
+                            continue;
+                        case '[':
+                            stack.push_back(']');
+                            ++p;
+                            p = skip_ws(p, end);
+                            if (p == end)
+                                return nullptr;
+                            if (*p == ']') {
+                                stack.pop_back();
+                                ++p;
+                                expect_value = false;
+                                break;
+                            }
+                            continue;
+                        case '"':
+                            p = skip_string(p, end);
+                            break;
+                        case 't':
+                            p = skip_literal(p, end, "true");
+                            break;
+                        case 'f':
+                            p = skip_literal(p, end, "false");
+                            break;
+                        case 'n':
+                            p = skip_literal(p, end, "null");
+                            break;
+                        default:
+                            p = skip_number(p, end);
+                            break;
+                        }
+                        if (!p)
+                            return nullptr;
+                        expect_value = false;
+                    }
+
+                    if (stack.empty())
+                        return p;
+
+                    p = skip_ws(p, end);
+                    if (p == end)
+                        return nullptr;
+                    if (*p == stack.back()) {
+                        stack.pop_back();
+                        ++p;
+                        if (stack.empty())
+                            return p; // the value may end exactly at 'end'
+                        continue;
+                    }
+                    if (*p != ',')
+                        fail("expected ',' or closing bracket");
+                    ++p;
+                    expect_value = true;
+                    if (stack.back() == '}') {
+                        p = skip_ws(p, end);
+                        if (p == end)
+                            return nullptr;
+                        if (*p != '"')
+                            fail("expected object key");
+                        p = skip_string(p, end);
+                        if (!p)
+                            return nullptr;
+                        p = skip_ws(p, end);
+                        if (p == end)
+                            return nullptr;
+                        if (*p++ != ':')
+                            fail("expected ':'");
+                    }
+                }
+            }
+
+            // Locale-independent, non-allocating and correctly rounded (libstdc++ implements from_chars
+            // with the Eisel-Lemire fast path). Out-of-range literals saturate to ±inf or ±0 instead of
+            // throwing like std::stod did; text that is not a number at all reads as 0.0, like a
+            // non-numeric coordinate always has.
+            inline double parse_number(const char *p, size_t n) {
+                double v = 0.0;
+                auto [ptr, ec] = std::from_chars(p, p + n, v);
+                if (ec == std::errc::result_out_of_range) {
+                    bool negative = n > 0 && p[0] == '-';
+                    std::string_view text(p, n);
+                    auto e = text.find_first_of("eE");
+                    bool tiny = e != std::string_view::npos && e + 1 < n && text[e + 1] == '-';
+                    double mag = tiny ? 0.0 : std::numeric_limits<double>::infinity();
+                    return negative ? -mag : mag;
+                }
+                if (ec != std::errc())
+                    return 0.0;
+                return v;
+            }
+
+            inline void append_utf8(std::string &out, std::uint32_t cp) {
+                if (cp < 0x80) {
+                    out += static_cast<char>(cp);
+                } else if (cp < 0x800) {
+                    out += static_cast<char>(0xC0 | (cp >> 6));
+                    out += static_cast<char>(0x80 | (cp & 0x3F));
+                } else if (cp < 0x10000) {
+                    out += static_cast<char>(0xE0 | (cp >> 12));
+                    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (cp & 0x3F));
+                } else {
+                    out += static_cast<char>(0xF0 | (cp >> 18));
+                    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (cp & 0x3F));
+                }
+            }
+
+            inline std::uint32_t hex4(const char *p) {
+                std::uint32_t v = 0;
+                for (int i = 0; i < 4; ++i) {
+                    char c = p[i];
+                    v <<= 4;
+                    if (c >= '0' && c <= '9')
+                        v |= static_cast<std::uint32_t>(c - '0');
+                    else if (c >= 'a' && c <= 'f')
+                        v |= static_cast<std::uint32_t>(c - 'a' + 10);
+                    else if (c >= 'A' && c <= 'F')
+                        v |= static_cast<std::uint32_t>(c - 'A' + 10);
+                    else
+                        fail("invalid \\u escape");
+                }
+                return v;
+            }
+
+            // Decodes the body of a string (the text between the quotes) into out
+            inline void unescape(std::string_view raw, std::string &out) {
+                out.clear();
+                out.reserve(raw.size());
+                const char *p = raw.data();
+                const char *end = p + raw.size();
+                while (p < end) {
+                    char c = *p++;
+                    if (c != '\\') {
+                        out += c;
+                        continue;
+                    }
+                    if (p == end)
+                        fail("truncated escape");
+                    switch (*p++) {
+                    case '"':
+                        out += '"';
+                        break;
+                    case '\\':
+                        out += '\\';
+                        break;
+                    case '/':
+                        out += '/';
+                        break;
+                    case 'b':
+                        out += '\b';
+                        break;
+                    case 'f':
+                        out += '\f';
+                        break;
+                    case 'n':
+                        out += '\n';
+                        break;
+                    case 'r':
+                        out += '\r';
+                        break;
+                    case 't':
+                        out += '\t';
+                        break;
+                    case 'u': {
+                        if (end - p < 4)
+                            fail("truncated \\u escape");
+                        std::uint32_t cp = hex4(p);
+                        p += 4;
+                        if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                            std::uint32_t lo = hex4(p + 2);
+                            if (lo >= 0xDC00 && lo < 0xE000) {
+                                cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                                p += 6;
+                            }
+                        }
+                        append_utf8(out, cp);
+                        break;
+                    }
+                    default:
+                        fail("invalid escape");
+                    }
+                }
+            }
+
+            // Compares the body of a string against a plain key, decoding escapes only if present
+            inline bool key_equals(std::string_view raw, std::string_view key) {
+                if (raw.find('\\') == std::string_view::npos)
+                    return raw == key;
+                std::string decoded;
+                unescape(raw, decoded);
+                return decoded == key;
+            }
+        } // namespace scan
+    } // namespace detail
+
+} // namespace vectkit
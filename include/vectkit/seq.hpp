@@ -0,0 +1,269 @@
+#pragma once
+
+#include "vectkit/decode.hpp"
+#include "vectkit/parser.hpp"
+#include "vectkit/pool.hpp"
+#include "vectkit/types.hpp"
+#include "vectkit/writter.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace vectkit {
+
+    // GeoJSON text sequences (RFC 8142): one JSON text per record, each introduced by an ASCII record
+    // separator (0x1E) and ended by a line feed. Plain newline-delimited files (one record per line, no
+    // separators) are read as well.
+    //
+    // The first record carries the header: vectkit writes it as a FeatureCollection with the usual
+    // 'properties' (crs, datum, heading, global properties) and no features, which any GeoJSON reader
+    // takes for an empty collection. A first record that is a Feature carrying crs/datum/heading in
+    // its own properties is accepted too. Every later record is one Feature. Records are independent,
+    // so a log can be appended to while it is being written, and read back in parallel. A last record
+    // left incomplete by an interrupted writer (no line feed after it, and its value cut off) is skipped.
+
+    namespace detail {
+        constexpr char record_separator = '\x1e';
+
+        // Calls record(text) for every non-blank record between begin and end. Records end at the next
+        // delimiter, so a chunk that starts just after one holds only whole records.
+        template <typename Record>
+        void for_each_record(const char *begin, const char *end, char delimiter, Record &&record) {
+            while (begin < end) {
+                auto *stop = static_cast<const char *>(std::memchr(begin, delimiter, size_t(end - begin)));
+                if (!stop)
+                    stop = end;
+                const char *first = scan::skip_ws(begin, stop);
+                if (first != stop)
+                    record(std::string_view(first, size_t(stop - first)));
+                begin = stop + 1;
+            }
+        }
+
+        inline void decode_record(FeatureDecoder &decoder, std::string_view text, std::vector<Feature> &out) {
+            Cursor c(text);
+            if (c.peek() != '{')
+                scan::fail("expected a Feature object");
+            decoder.decode(c, out);
+            if (c.peek() != 0)
+                scan::fail("unexpected trailing characters in record");
+        }
+
+        // Decodes a whole sequence into fc. The records after the header are cut into chunks at record
+        // delimiters and decoded on up to options.threads threads; the features and any error are those
+        // of a front-to-back read.
+        inline void decode_seq(std::string_view text, const ReadOptions &options, ParseScratch &scratch,
+                               FeatureCollection &fc, std::shared_ptr<const void> source) {
+            const char *begin = scan::skip_ws(text.data(), text.data() + text.size());
+            const char *end = text.data() + text.size();
+            // RFC 8142 records may span lines; without separators a record is one line
+            char delimiter = begin < end && *begin == record_separator ? record_separator : '\n';
+            if (delimiter == record_separator)
+                ++begin;
+
+            auto *stop = static_cast<const char *>(std::memchr(begin, delimiter, size_t(end - begin)));
+            if (!stop)
+                stop = end;
+            if (scan::skip_ws(begin, stop) == stop)
+                throw std::runtime_error("vectkit::ReadFeatureSeq(): no header record");
+
+            CRS crs = decode_document(std::string_view(begin, size_t(stop - begin)), options, scratch, fc, source);
+            begin = stop == end ? end : stop + 1;
+
+            FeatureFilter filter = feature_filter(options);
+            if (options.region) {
+                region_test(*options.region, fc.datum, crs, scratch.region);
+                filter.region = &scratch.region;
+            }
+            FeatureDecoder &decoder = scratch.collection;
+            decoder.reset(fc.datum, crs);
+            decoder.select(filter);
+            decoder.defer_properties(std::move(source));
+
+            // A writer cut off mid-record leaves a last record without its line feed. If that record
+            // also ends before its value does, it is skipped (RFC 7464, section 2.3); one that is complete
+            // but malformed still fails the read.
+            const char *tail = end;
+            if (begin < end && end[-1] != '\n') {
+                size_t at = std::string_view(begin, size_t(end - begin)).rfind(delimiter);
+                tail = at == std::string_view::npos ? begin : begin + at + 1;
+            }
+            auto decode_tail = [&, last = end] {
+                for_each_record(tail, last, delimiter, [&](std::string_view record) {
+                    if (scan::skip_value(record.data(), record.data() + record.size()))
+                        decode_record(decoder, record, fc.features);
+                });
+                scratch.feature_hint = fc.features.size();
+            };
+            end = tail;
+
+            size_t bytes = size_t(end - begin);
+            size_t threads = resolve_threads(options.threads);
+            size_t wanted = threads > 1 ? std::min(threads * 4, bytes / min_parallel_chunk) : 1;
+            if (wanted <= 1) {
+                for_each_record(begin, end, delimiter,
+                                [&](std::string_view record) { decode_record(decoder, record, fc.features); });
+                decode_tail();
+                return;
+            }
+
+            // Unlike a features array, a delimiter is always a record boundary, so every cut is exact
+            std::vector<const char *> cuts{begin};
+            for (size_t k = 1; k < wanted; ++k) {
+                const char *guess = begin + bytes / wanted * k;
+                auto *at = static_cast<const char *>(std::memchr(guess, delimiter, size_t(end - guess)));
+                if (!at)
+                    break;
+                if (at + 1 > cuts.back())
+                    cuts.push_back(at + 1);
+            }
+            cuts.push_back(end);
+
+            std::vector<std::vector<Feature>> chunks(cuts.size() - 1);
+            parallel_for(chunks.size(), threads, [&](size_t k) {
+                FeatureDecoder local = decoder.fork();
+                for_each_record(cuts[k], cuts[k + 1], delimiter,
+                                [&](std::string_view record) { decode_record(local, record, chunks[k]); });
+            });
+
+            size_t total = fc.features.size();
+            for (const auto &chunk : chunks)
+                total += chunk.size();
+            fc.features.reserve(total);
+            for (auto &chunk : chunks)
+                std::move(chunk.begin(), chunk.end(), std::back_inserter(fc.features));
+            decode_tail();
+        }
+
+        inline void read_seq_document(std::string_view text, const ReadOptions &options, ParseScratch &scratch,
+                                      FeatureCollection &fc, std::shared_ptr<const void> source = nullptr) {
+            if (!options.lazy_properties) {
+                source.reset();
+            } else if (!source) {
+                auto copy = std::make_shared<const std::string>(text);
+                text = *copy;
+                source = std::move(copy);
+            }
+            try {
+                decode_seq(text, options, scratch, fc, std::move(source));
+            } catch (const scan::ParseError &e) {
+                throw std::runtime_error(std::string("vectkit::ReadFeatureSeq(): failed to parse JSON: ") + e.what());
+            }
+        }
+
+        inline void append_seq_header(std::string &out, FeatureCollection const &fc, vectkit::CRS outputCrs) {
+            out += record_separator;
+            out += R"({"type":"FeatureCollection","properties":)";
+            append_header(out, fc, outputCrs);
+            out += R"(,"features":[]})";
+            out += '\n';
+        }
+
+        inline void append_seq_record(std::string &out, Feature const &f, const dp::Geo &datum,
+                                      const OutputFormat &format) {
+            out += record_separator;
+            append_feature(out, f, datum, format);
+            out += '\n';
+        }
+
+        // Feature records on several threads, handed to emit like serialize_features' chunks
+        template <typename Emit>
+        void serialize_records(FeatureCollection const &fc, const OutputFormat &format, size_t threads,
+                               size_t chunk_bytes, std::vector<std::string> &chunks, Emit &&emit) {
+            serialize_items(
+                fc.features.size(), threads, chunk_bytes, chunks,
+                [&](std::string &out, size_t i) { append_seq_record(out, fc.features[i], fc.datum, format); },
+                std::forward<Emit>(emit));
+        }
+
+        inline void append_seq(std::string &out, FeatureCollection const &fc, const OutputFormat &format) {
+            append_seq_header(out, fc, format.crs);
+            for (auto const &f : fc.features)
+                append_seq_record(out, f, fc.datum, format);
+        }
+    } // namespace detail
+
+    // Reads a GeoJSON text sequence; gzip and zstd files are decompressed first, like every reader.
+    // ReadOptions apply as for ReadFeatureCollection.
+    inline FeatureCollection ReadFeatureSeq(const std::filesystem::path &file, const ReadOptions &options = {}) {
+        FeatureCollection fc;
+        detail::ParseScratch scratch;
+        detail::MappedFile input;
+        detail::read_file_text(file, "vectkit::ReadFeatureSeq()", options, scratch, input,
+                               [&](std::string_view text, std::shared_ptr<const void> source) {
+                                   detail::read_seq_document(text, options, scratch, fc, std::move(source));
+                               });
+        return fc;
+    }
+
+    inline FeatureCollection read_seq_from_buffer(std::string_view text, const ReadOptions &options = {}) {
+        FeatureCollection fc;
+        detail::ParseScratch scratch;
+        detail::read_seq_document(text, options, scratch, fc);
+        return fc;
+    }
+
+    // Writes fc as a GeoJSON text sequence: the header record, then one record per feature. With
+    // WriteOptions, coordinates can be rounded and records are serialized on options.threads threads,
+    // as for write_to_buffer; the text is the same for any thread count.
+    inline void write_seq_to_buffer(FeatureCollection const &fc, std::string &out, const WriteOptions &options) {
+        detail::OutputFormat format(options);
+        out.clear();
+        if (detail::resolve_threads(options.threads) <= 1) {
+            detail::append_seq(out, fc, format);
+            return;
+        }
+        detail::append_seq_header(out, fc, format.crs);
+        std::vector<std::string> chunks;
+        detail::serialize_records(fc, format, options.threads, size_t(1) << 20, chunks,
+                                  [&](std::span<const std::string> parts) {
+                                      for (const auto &part : parts)
+                                          out += part;
+                                  });
+    }
+
+    inline void write_seq_to_buffer(FeatureCollection const &fc, std::string &out,
+                                    vectkit::CRS outputCrs = vectkit::CRS::WGS) {
+        out.clear();
+        detail::append_seq(out, fc, outputCrs);
+    }
+
+    inline void WriteFeatureSeq(FeatureCollection const &fc, std::filesystem::path const &outPath,
+                                const WriteOptions &options) {
+        // Flushed in chunks like FeatureWriter, so memory does not grow with the collection
+        constexpr size_t buffer_size = size_t(4) << 20;
+        detail::OutputFormat format(options);
+        detail::OutputFile out(outPath, "vectkit::WriteFeatureSeq()", buffer_size);
+        detail::append_seq_header(out.buffer(), fc, format.crs);
+        size_t threads = detail::resolve_threads(options.threads);
+        if (threads <= 1 || fc.features.size() < 2) {
+            for (auto const &f : fc.features) {
+                detail::append_seq_record(out.buffer(), f, fc.datum, format);
+                out.commit();
+            }
+        } else {
+            std::vector<std::string> chunks;
+            size_t chunk_bytes = std::max(buffer_size / (2 * threads), size_t(1) << 16);
+            detail::serialize_records(fc, format, threads, chunk_bytes, chunks,
+                                      [&](std::span<const std::string> parts) { out.write_parts(parts); });
+        }
+        out.close();
+    }
+
+    inline void WriteFeatureSeq(FeatureCollection const &fc, std::filesystem::path const &outPath,
+                                vectkit::CRS outputCrs = vectkit::CRS::WGS) {
+        WriteFeatureSeq(fc, outPath, WriteOptions{.crs = outputCrs});
+    }
+
+} // namespace vectkit
@@ -0,0 +1,365 @@
+#pragma once
+
+#include "json.hpp"
+#include "vectkit/compress.hpp"
+#include "vectkit/decode.hpp"
+#include "vectkit/io.hpp"
+#include "vectkit/parser.hpp"
+#include "vectkit/scan.hpp"
+#include "vectkit/types.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace vectkit {
+
+    namespace detail {
+        // Sliding window over an InputSource. Consumed bytes are dropped on the next refill, so the window
+        // only ever holds the value currently being scanned plus one read chunk.
+        class InputWindow {
+          public:
+            InputWindow(std::unique_ptr<InputSource> src, size_t chunk) : src_(std::move(src)), chunk_(chunk) {}
+
+            const char *begin() const { return buf_.data() + pos_; }
+            const char *end() const { return buf_.data() + buf_.size(); }
+            void consume(const char *p) { pos_ = static_cast<size_t>(p - buf_.data()); }
+            void skip(size_t n) { pos_ += n; }
+
+            // Drops consumed bytes and appends at least one chunk. The read size grows with the pending
+            // bytes, so a value larger than the chunk is rescanned a logarithmic number of times.
+            bool fill() {
+                buf_.erase(0, pos_);
+                pos_ = 0;
+                size_t old = buf_.size();
+                size_t want = std::max(chunk_, old);
+                buf_.resize(old + want);
+                size_t got = src_->read(buf_.data() + old, want);
+                buf_.resize(old + got);
+                return got > 0;
+            }
+
+            bool rewind() {
+                if (!src_->rewind())
+                    return false;
+                buf_.clear();
+                pos_ = 0;
+                return true;
+            }
+
+            // Next non-whitespace byte without consuming it, or 0 at end of input
+            char peek() {
+                for (;;) {
+                    const char *p = scan::skip_ws(begin(), end());
+                    consume(p);
+                    if (p < end())
+                        return *p;
+                    if (!fill())
+                        return 0;
+                }
+            }
+
+            // Consumes the next complete JSON value. The view is invalidated by the next peek/value call.
+            std::string_view value() {
+                peek();
+                for (;;) {
+                    const char *e = scan::skip_value(begin(), end());
+                    if (e) {
+                        std::string_view v(begin(), static_cast<size_t>(e - begin()));
+                        consume(e);
+                        return v;
+                    }
+                    if (!fill())
+                        scan::fail("unexpected end of input");
+                }
+            }
+
+            // Consumes an object key and the ':' after it
+            std::string key() {
+                if (peek() != '"')
+                    scan::fail("expected object key");
+                auto raw = value();
+                std::string k;
+                scan::unescape(raw.substr(1, raw.size() - 2), k);
+                if (peek() != ':')
+                    scan::fail("expected ':'");
+                skip(1);
+                return k;
+            }
+
+          private:
+            std::unique_ptr<InputSource> src_;
+            size_t chunk_;
+            std::string buf_;
+            size_t pos_ = 0;
+        };
+    } // namespace detail
+
+    // Reads a FeatureCollection one feature at a time. The header (crs, datum, heading and global
+    // properties) is decoded by the constructor; features are then pulled with next() or a range-for.
+    // Only one input chunk and the feature being decoded are held in memory, whatever the file size.
+    // gzip and zstd files are decompressed on the fly as the window advances.
+    //
+    // If 'properties' comes after 'features' in the file, the features are skipped on a first pass and
+    // the file is read a second time once the datum is known.
+    class FeatureReader {
+      public:
+        explicit FeatureReader(const std::filesystem::path &file, size_t chunk_size = size_t(1) << 20)
+            : window_(open_source(file), chunk_size) {
+            try {
+                begin_object();
+                in_features_ = scan_members();
+                if (!in_features_)
+                    end_pass();
+            } catch (const detail::scan::ParseError &e) {
+                rethrow(e);
+            }
+        }
+
+        FeatureReader(const FeatureReader &) = delete;
+        FeatureReader &operator=(const FeatureReader &) = delete;
+
+        // Datum, heading and global properties; features is always empty
+        const FeatureCollection &header() const { return header_; }
+        const dp::Geo &datum() const { return header_.datum; }
+        const dp::Euler &heading() const { return header_.heading; }
+        CRS crs() const { return crs_; }
+
+        // Moves the next feature into out; returns false once the collection is exhausted
+        bool next(Feature &out) {
+            while (pending_pos_ == pending_.size()) {
+                if (!in_features_)
+                    return false;
+                pending_.clear();
+                pending_pos_ = 0;
+                try {
+                    decode_next();
+                } catch (const detail::scan::ParseError &e) {
+                    rethrow(e);
+                }
+            }
+            out = std::move(pending_[pending_pos_++]);
+            return true;
+        }
+
+        class iterator {
+          public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = Feature;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Feature *;
+            using reference = Feature &;
+
+            iterator() = default;
+            explicit iterator(FeatureReader *reader) : reader_(reader) { ++*this; }
+
+            reference operator*() { return current_; }
+            pointer operator->() { return &current_; }
+            iterator &operator++() {
+                if (!reader_->next(current_))
+                    reader_ = nullptr;
+                return *this;
+            }
+            void operator++(int) { ++*this; }
+            bool operator==(const iterator &other) const { return reader_ == other.reader_; }
+
+          private:
+            FeatureReader *reader_ = nullptr;
+            Feature current_;
+        };
+
+        iterator begin() { return iterator(this); }
+        iterator end() { return {}; }
+
+      private:
+        static std::unique_ptr<detail::InputSource> open_source(const std::filesystem::path &file) {
+            auto src = std::make_unique<detail::FileSource>();
+            if (!src->open(file))
+                throw std::runtime_error("vectkit::FeatureReader(): cannot open \"" + file.string() + '\"');
+            return std::make_unique<detail::DecodingSource>(std::move(src), "vectkit::FeatureReader()");
+        }
+
+        [[noreturn]] static void rethrow(const detail::scan::ParseError &e) {
+            throw std::runtime_error(std::string("vectkit::FeatureReader(): failed to parse JSON: ") + e.what());
+        }
+
+        void begin_object() {
+            if (window_.peek() != '{')
+                throw std::runtime_error("vectkit::FeatureReader(): top-level object has no string 'type' field");
+            window_.skip(1);
+            after_member_ = false;
+            if (window_.peek() == '}') {
+                window_.skip(1);
+                after_member_ = true;
+                object_closed_ = true;
+            }
+        }
+
+        // Walks top-level members until the features array is entered (true) or the object closes (false)
+        bool scan_members() {
+            while (!object_closed_) {
+                if (after_member_) {
+                    char c = window_.peek();
+                    if (c == '}') {
+                        window_.skip(1);
+                        object_closed_ = true;
+                        break;
+                    }
+                    if (c != ',')
+                        detail::scan::fail("expected ',' or '}'");
+                    window_.skip(1);
+                }
+                after_member_ = true;
+
+                std::string key = window_.key();
+                if (key == "features" && !features_done_) {
+                    if (!have_header_) {
+                        skip_features();
+                        continue;
+                    }
+                    if (window_.peek() == '[') {
+                        window_.skip(1);
+                        first_feature_ = true;
+                        return true;
+                    }
+                    window_.value();
+                    features_done_ = true;
+                    continue;
+                }
+
+                auto v = window_.value();
+                if (second_pass_)
+                    continue;
+                if (key == "type" && !have_type_) {
+                    have_type_ = true;
+                    if (v.front() == '"')
+                        detail::scan::unescape(v.substr(1, v.size() - 2), type_);
+                    else
+                        type_string_ = false;
+                    check_type();
+                } else if (key == "properties" && !have_header_) {
+                    // Same DOM path and error as ReadFeatureCollection's header
+                    detail::JsonArena arena;
+                    crs_ = detail::parse_header(arena.parse(v, "invalid 'properties'"), header_);
+                    decoder_ = detail::FeatureDecoder(header_.datum, crs_);
+                    have_header_ = true;
+                }
+            }
+            return false;
+        }
+
+        // First pass only: the datum is not known yet, so step over the features one by one to keep the
+        // window small, and come back for them once the header has been read
+        void skip_features() {
+            skipped_features_ = true;
+            if (window_.peek() != '[') {
+                window_.value();
+                return;
+            }
+            window_.skip(1);
+            if (window_.peek() == ']') {
+                window_.skip(1);
+                return;
+            }
+            for (;;) {
+                window_.value();
+                char c = window_.peek();
+                window_.skip(1);
+                if (c == ']')
+                    return;
+                if (c != ',')
+                    detail::scan::fail("expected ',' or ']'");
+            }
+        }
+
+        void check_type() const {
+            if (!type_string_)
+                throw std::runtime_error("vectkit::FeatureReader(): top-level object has no string 'type' field");
+            if (have_type_ && type_ != "FeatureCollection")
+                throw std::runtime_error("vectkit::FeatureReader(): expected a FeatureCollection, got '" + type_ +
+                                         "'");
+        }
+
+        // Called whenever the top-level object has been closed
+        void end_pass() {
+            if (window_.peek() != 0)
+                detail::scan::fail("unexpected trailing characters");
+            if (!have_type_)
+                type_string_ = false;
+            check_type();
+            if (!have_header_)
+                detail::parse_header(nullptr, header_); // throws the usual "missing top-level 'properties'"
+
+            if (skipped_features_ && !second_pass_) {
+                if (!window_.rewind())
+                    throw std::runtime_error(
+                        "vectkit::FeatureReader(): 'properties' must precede 'features' in non-seekable input");
+                second_pass_ = true;
+                object_closed_ = false;
+                begin_object();
+                in_features_ = scan_members();
+                if (!in_features_)
+                    end_pass();
+            }
+        }
+
+        void decode_next() {
+            char c = window_.peek();
+            if (c == ']' || (!first_feature_ && c != ',')) {
+                if (c != ']')
+                    detail::scan::fail("expected ',' or ']'");
+                window_.skip(1);
+                in_features_ = false;
+                features_done_ = true;
+                scan_members(); // a repeated 'features' key is skipped like any other member
+                end_pass();
+                return;
+            }
+            if (!first_feature_)
+                window_.skip(1);
+            first_feature_ = false;
+
+            detail::Cursor feature(window_.value());
+            decoder_.decode(feature, pending_);
+        }
+
+        detail::InputWindow window_;
+        FeatureCollection header_;
+        CRS crs_ = CRS::ENU;
+        std::string type_;
+
+        bool have_type_ = false;
+        bool type_string_ = true;
+        bool have_header_ = false;
+        bool skipped_features_ = false;
+        bool second_pass_ = false;
+        bool after_member_ = false;
+        bool object_closed_ = false;
+        bool in_features_ = false;
+        bool first_feature_ = false;
+        bool features_done_ = false;
+
+        detail::FeatureDecoder decoder_;
+        std::vector<Feature> pending_;
+        size_t pending_pos_ = 0;
+    };
+
+    // Streams every feature of a collection through on_feature(Feature &&) and returns the header
+    // (datum, heading, global properties) with an empty feature list
+    template <typename Callback>
+    FeatureCollection ReadFeatures(const std::filesystem::path &file, Callback &&on_feature) {
+        FeatureReader reader(file);
+        Feature f;
+        while (reader.next(f))
+            on_feature(std::move(f));
+        return reader.header();
+    }
+
+} // namespace vectkit
@@ -3,31 +3,678 @@
 #include <concord/concord.hpp>
 #include <datapod/datapod.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
 namespace dp = ::datapod;
 
 namespace vectkit {
+    // Multi-part geometries keep all their coordinates in one flat 'points' buffer. Parts and rings are
+    // marked by end offsets: part i covers [ends[i - 1], ends[i]), the first one starting at 0. However
+    // many parts there are, a geometry is two or three allocations.
+    namespace detail {
+        inline std::span<const dp::Point> part(const std::vector<dp::Point> &points,
+                                               const std::vector<std::uint32_t> &ends, size_t i) {
+            std::uint32_t begin = i == 0 ? 0 : ends[i - 1];
+            return std::span<const dp::Point>(points).subspan(begin, ends[i] - begin);
+        }
+    } // namespace detail
+
+    struct MultiPoint {
+        std::vector<dp::Point> points;
+    };
+
+    struct MultiLineString {
+        std::vector<dp::Point> points;
+        std::vector<std::uint32_t> lines; // end of each line in points
+
+        size_t size() const { return lines.size(); }
+        std::span<const dp::Point> line(size_t i) const { return detail::part(points, lines, i); }
+    };
+
+    // Polygon with inner rings. Ring 0 is the outer boundary; rings are stored as written (closed).
+    struct PolygonWithHoles {
+        std::vector<dp::Point> points;
+        std::vector<std::uint32_t> rings; // end of each ring in points
+
+        size_t size() const { return rings.size(); }
+        std::span<const dp::Point> ring(size_t i) const { return detail::part(points, rings, i); }
+    };
+
+    struct MultiPolygon {
+        std::vector<dp::Point> points;
+        std::vector<std::uint32_t> rings;    // end of each ring in points
+        std::vector<std::uint32_t> polygons; // end of each polygon in rings; its first ring is the outer one
+
+        size_t size() const { return polygons.size(); }
+        std::span<const dp::Point> ring(size_t r) const { return detail::part(points, rings, r); }
+        // Rings [first, last) of polygon i
+        std::pair<size_t, size_t> polygon(size_t i) const { return {i == 0 ? 0 : polygons[i - 1], polygons[i]}; }
+    };
+
     // Internal geometry representation: all coordinates are stored as Point (ENU/local system)
-    // Regardless of input CRS, coordinates are converted to local coordinate system during parsing
-    using Geometry = std::variant<dp::Point, dp::Segment, std::vector<dp::Point>, dp::Polygon>;
+    // Regardless of input CRS, coordinates are converted to local coordinate system during parsing.
+    // The multi-part types are only produced by reads with ReadOptions::keep_multipart.
+    using Geometry = std::variant<dp::Point, dp::Segment, std::vector<dp::Point>, dp::Polygon, MultiPoint,
+                                  MultiLineString, PolygonWithHoles, MultiPolygon>;
 
     // Simple CRS representation - used for input parsing and output formatting
     enum class CRS { WGS, ENU };
 
+    // GeoJSON geometry types, as named by a geometry's "type" member
+    enum class GeometryType : std::uint8_t {
+        Unknown,
+        Point,
+        LineString,
+        Polygon,
+        MultiPoint,
+        MultiLineString,
+        MultiPolygon,
+        GeometryCollection
+    };
+
+    namespace detail {
+        class FeatureDecoder;
+
+        // Shortest text that reads back as the same double. Integral values get a ".0" so they read
+        // back as numbers rather than integers; non-finite ones, which JSON cannot hold, become null.
+        // buf needs room for 32 characters. Returns the end of the text.
+        inline char *format_number(char *buf, double v) {
+            if (!std::isfinite(v)) {
+                return std::copy_n("null", 4, buf);
+            }
+            char *end = std::to_chars(buf, buf + 32, v).ptr;
+            if (std::find_if(buf, end, [](char c) { return c == '.' || c == 'e'; }) == end) {
+                *end++ = '.';
+                *end++ = '0';
+            }
+            return end;
+        }
+
+        // The body of a JSON string for s, without the quotes. Every byte below 0x20 is escaped, so the
+        // text is valid JSON and the reader, which rejects raw control characters, reads it back.
+        inline void append_escaped(std::string &out, std::string_view s) {
+            for (char c : s) {
+                switch (c) {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\b':
+                    out += "\\b";
+                    break;
+                case '\f':
+                    out += "\\f";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        // Other control characters have no short escape and are not allowed raw
+                        static constexpr char hex[] = "0123456789abcdef";
+                        out += "\\u00";
+                        out += hex[(c >> 4) & 0xF];
+                        out += hex[c & 0xF];
+                    } else {
+                        out += c;
+                    }
+                    break;
+                }
+            }
+        }
+    } // namespace detail
+
+    // A property value with its JSON type. Integers that fit 64 bits are Int, other numbers Number;
+    // arrays, objects and numbers a double cannot hold are kept as compact JSON text (Raw).
+    //
+    // Comparing with a string compares text(), the form the untyped API used to hold, so
+    // props.at("count") == "42" still works; typed code reads as_int() & co. without any conversion.
+    class PropertyValue {
+      public:
+        enum class Type : std::uint8_t { Null, Bool, Int, Number, String, Raw };
+
+        PropertyValue() = default;
+        PropertyValue(std::nullptr_t) {}
+        PropertyValue(bool b) : type_(Type::Bool), bool_(b) {}
+        template <std::integral I>
+            requires(!std::is_same_v<I, bool>)
+        PropertyValue(I i) : type_(Type::Int), int_(static_cast<std::int64_t>(i)) {}
+        PropertyValue(double d) : type_(Type::Number), number_(d) {}
+        PropertyValue(std::string s) : type_(Type::String), text_(std::move(s)) {}
+        PropertyValue(std::string_view s) : type_(Type::String), text_(s) {}
+        PropertyValue(const char *s) : type_(Type::String), text_(s) {}
+
+        // An array or object, given as JSON text
+        static PropertyValue raw(std::string json) {
+            PropertyValue v(std::move(json));
+            v.type_ = Type::Raw;
+            return v;
+        }
+
+        // A JSON number literal: Int when it fits 64 bits, Number otherwise, or the literal itself as Raw
+        // text when it is beyond the range of a double (1e400), so writing it back does not lose it
+        static PropertyValue number(std::string_view literal) {
+            PropertyValue v;
+            v.assign_number(literal);
+            return v;
+        }
+
+        Type type() const { return type_; }
+        bool is_null() const { return type_ == Type::Null; }
+        bool is_bool() const { return type_ == Type::Bool; }
+        bool is_int() const { return type_ == Type::Int; }
+        bool is_number() const { return type_ == Type::Int || type_ == Type::Number; } // Int included
+        bool is_string() const { return type_ == Type::String; }
+        bool is_raw() const { return type_ == Type::Raw; }
+
+        // These throw std::runtime_error for a value of another type
+        bool as_bool() const { return expect(Type::Bool, "bool").bool_; }
+        std::int64_t as_int() const { return expect(Type::Int, "integer").int_; }
+        double as_number() const {
+            if (type_ == Type::Int)
+                return static_cast<double>(int_);
+            return expect(Type::Number, "number").number_;
+        }
+        const std::string &as_string() const { return expect(Type::String, "string").text_; }
+        const std::string &as_raw() const { return expect(Type::Raw, "raw JSON").text_; }
+
+        // Strings as they are, anything else as compact JSON text
+        std::string text() const {
+            if (type_ == Type::String || type_ == Type::Raw)
+                return text_;
+            char buf[32];
+            return std::string(buf, format(buf));
+        }
+
+        friend bool operator==(const PropertyValue &a, const PropertyValue &b) {
+            if (a.is_number() && b.is_number()) {
+                if (a.type_ == Type::Int && b.type_ == Type::Int)
+                    return a.int_ == b.int_;
+                return a.as_number() == b.as_number();
+            }
+            if (a.type_ != b.type_)
+                return false;
+            switch (a.type_) {
+            case Type::Bool:
+                return a.bool_ == b.bool_;
+            case Type::String:
+            case Type::Raw:
+                return a.text_ == b.text_;
+            default:
+                return true;
+            }
+        }
+        friend bool operator==(const PropertyValue &v, std::string_view s) {
+            if (v.type_ == Type::String || v.type_ == Type::Raw)
+                return v.text_ == s;
+            char buf[32];
+            return std::string_view(buf, static_cast<size_t>(v.format(buf) - buf)) == s;
+        }
+        friend bool operator==(const PropertyValue &v, const std::string &s) { return v == std::string_view(s); }
+        friend bool operator==(const PropertyValue &v, const char *s) { return v == std::string_view(s); }
+
+      private:
+        friend class detail::FeatureDecoder;
+
+        const PropertyValue &expect(Type type, const char *name) const {
+            if (type_ != type)
+                throw std::runtime_error(std::string("vectkit::PropertyValue: not a ") + name);
+            return *this;
+        }
+
+        // JSON text of a non-string value into buf (32 characters)
+        char *format(char *buf) const {
+            switch (type_) {
+            case Type::Bool:
+                return std::copy_n(bool_ ? "true" : "false", bool_ ? 4 : 5, buf);
+            case Type::Int:
+                return std::to_chars(buf, buf + 32, int_).ptr;
+            case Type::Number:
+                return detail::format_number(buf, number_);
+            default:
+                return std::copy_n("null", 4, buf);
+            }
+        }
+
+        // The string buffer, for a decoder to fill in place as a value of the given type
+        std::string &text(Type type) {
+            type_ = type;
+            return text_;
+        }
+
+        void assign_number(std::string_view literal) {
+            const char *end = literal.data() + literal.size();
+            std::int64_t i = 0;
+            auto [ptr, ec] = std::from_chars(literal.data(), end, i);
+            if (ec == std::errc() && ptr == end) {
+                type_ = Type::Int;
+                int_ = i;
+                return;
+            }
+            double d = 0.0;
+            if (std::from_chars(literal.data(), end, d).ec == std::errc::result_out_of_range) {
+                text(Type::Raw).assign(literal);
+                return;
+            }
+            type_ = Type::Number;
+            number_ = d;
+        }
+
+        Type type_ = Type::Null;
+        union {
+            bool bool_;
+            std::int64_t int_;
+            double number_ = 0.0;
+        };
+        std::string text_;
+    };
+
+    namespace detail {
+        // Property key names shared by the whole process, each stored once and never removed. The table
+        // stops growing at max_names names or max_bytes of text, so input with ever new keys (ids used
+        // as keys, say) cannot take memory without bound; names it no longer takes are not interned.
+        class KeyTable {
+          public:
+            static constexpr size_t max_names = size_t(1) << 16;
+            static constexpr size_t max_bytes = size_t(4) << 20;
+
+            static KeyTable &instance() {
+                static KeyTable table;
+                return table;
+            }
+
+            // The stored name, or nullptr if it is not stored and the table is full
+            const std::string *intern(std::string_view name) {
+                {
+                    std::shared_lock lock(mutex_);
+                    auto it = index_.find(name);
+                    if (it != index_.end())
+                        return it->second;
+                }
+                std::unique_lock lock(mutex_);
+                auto it = index_.find(name);
+                if (it != index_.end())
+                    return it->second;
+                if (names_.size() == max_names || bytes_ + name.size() > max_bytes)
+                    return nullptr;
+                const std::string *stored = &names_.emplace_back(name);
+                index_.emplace(*stored, stored);
+                bytes_ += name.size();
+                return stored;
+            }
+
+            size_t size() {
+                std::shared_lock lock(mutex_);
+                return names_.size();
+            }
+
+          private:
+            std::shared_mutex mutex_;
+            std::deque<std::string> names_; // stable addresses
+            std::unordered_map<std::string_view, const std::string *> index_;
+            size_t bytes_ = 0;
+        };
+    } // namespace detail
+
+    // An interned property key. All keys with the same name point at one stored string, so a feature
+    // holds 8 bytes per key and comparing two keys compares pointers. Making a key from a name looks
+    // it up once; code that reads the same property from many features can keep the key (e.g. a
+    // static PropertyKey for "type") and find it without hashing or comparing any text.
+    //
+    // Once the key table is full, a name it does not hold gets a key that owns a reference-counted
+    // copy of the name instead; such keys compare by text and are freed with their last copy.
+    class PropertyKey {
+      public:
+        PropertyKey() : PropertyKey(std::string_view()) {}
+        PropertyKey(std::string_view name) {
+            if (const std::string *interned = detail::KeyTable::instance().intern(name))
+                bits_ = reinterpret_cast<std::uintptr_t>(interned);
+            else
+                bits_ = reinterpret_cast<std::uintptr_t>(new Owned{std::string(name), {1}}) | owned_bit;
+        }
+        PropertyKey(const std::string &name) : PropertyKey(std::string_view(name)) {}
+        PropertyKey(const char *name) : PropertyKey(std::string_view(name)) {}
+
+        PropertyKey(const PropertyKey &other) noexcept : bits_(other.bits_) { retain(); }
+        PropertyKey &operator=(const PropertyKey &other) noexcept {
+            other.retain();
+            release();
+            bits_ = other.bits_;
+            return *this;
+        }
+        ~PropertyKey() { release(); }
+
+        const std::string &name() const {
+            if (bits_ & owned_bit)
+                return owned()->name;
+            return *reinterpret_cast<const std::string *>(bits_);
+        }
+        operator const std::string &() const { return name(); }
+
+        // Whether the name is in the shared key table (false once the table is full)
+        bool interned() const { return !(bits_ & owned_bit); }
+
+        // Interned keys are equal only if they are the same pointer; a name with an owned key is not in
+        // the table, so only two owned keys need their text compared
+        friend bool operator==(const PropertyKey &a, const PropertyKey &b) {
+            return a.bits_ == b.bits_ || ((a.bits_ & b.bits_ & owned_bit) && a.name() == b.name());
+        }
+        friend bool operator==(const PropertyKey &a, std::string_view b) { return a.name() == b; }
+        friend bool operator==(const PropertyKey &a, const std::string &b) { return a.name() == b; }
+        friend bool operator==(const PropertyKey &a, const char *b) { return a.name() == b; }
+
+      private:
+        friend struct std::hash<PropertyKey>;
+
+        struct Owned {
+            std::string name;
+            std::atomic<size_t> refs;
+        };
+        static constexpr std::uintptr_t owned_bit = 1; // names and Owned are at least 8-byte aligned
+
+        Owned *owned() const { return reinterpret_cast<Owned *>(bits_ & ~owned_bit); }
+        void retain() const {
+            if (bits_ & owned_bit)
+                owned()->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        void release() {
+            if ((bits_ & owned_bit) && owned()->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete owned();
+        }
+
+        std::uintptr_t bits_;
+    };
+
+    // Properties as a flat array of (key, value) entries in insertion order. Features carry a handful
+    // of properties, so scanning a few interned keys beats hashing, and a whole set is one allocation.
+    // Entries left over by clear() or erase() keep their string buffers for the next insert.
+    class PropertyMap {
+      public:
+        using key_type = PropertyKey;
+        using mapped_type = PropertyValue;
+        using value_type = std::pair<PropertyKey, PropertyValue>;
+        using size_type = size_t;
+        using iterator = std::vector<value_type>::iterator;
+        using const_iterator = std::vector<value_type>::const_iterator;
+
+        PropertyMap() = default;
+        PropertyMap(std::initializer_list<value_type> init) : PropertyMap(init.begin(), init.end()) {}
+        // From any map-like range, e.g. a std::unordered_map<std::string, std::string>
+        template <typename It> PropertyMap(It first, It last) {
+            for (; first != last; ++first)
+                insert_or_assign(first->first, first->second);
+        }
+        PropertyMap(const PropertyMap &other) : entries_(other.begin(), other.end()), size_(other.size_) {}
+        PropertyMap(PropertyMap &&other) noexcept
+            : entries_(std::move(other.entries_)), size_(std::exchange(other.size_, 0)) {}
+        PropertyMap &operator=(const PropertyMap &other) {
+            if (this != &other) {
+                entries_.assign(other.begin(), other.end());
+                size_ = other.size_;
+            }
+            return *this;
+        }
+        PropertyMap &operator=(PropertyMap &&other) noexcept {
+            entries_ = std::move(other.entries_);
+            size_ = std::exchange(other.size_, 0);
+            return *this;
+        }
+
+        iterator begin() { return entries_.begin(); }
+        iterator end() { return entries_.begin() + static_cast<std::ptrdiff_t>(size_); }
+        const_iterator begin() const { return entries_.begin(); }
+        const_iterator end() const { return entries_.begin() + static_cast<std::ptrdiff_t>(size_); }
+        bool empty() const { return size_ == 0; }
+        size_type size() const { return size_; }
+        void reserve(size_type n) { entries_.reserve(n); }
+
+        iterator find(const PropertyKey &key) {
+            return std::find_if(begin(), end(), [&](const value_type &e) { return e.first == key; });
+        }
+        const_iterator find(const PropertyKey &key) const {
+            return std::find_if(begin(), end(), [&](const value_type &e) { return e.first == key; });
+        }
+        // By name: compares the text of each key, without interning the name
+        template <typename K>
+            requires std::convertible_to<const K &, std::string_view>
+        iterator find(const K &name) {
+            std::string_view n(name);
+            return std::find_if(begin(), end(), [&](const value_type &e) { return e.first == n; });
+        }
+        template <typename K>
+            requires std::convertible_to<const K &, std::string_view>
+        const_iterator find(const K &name) const {
+            std::string_view n(name);
+            return std::find_if(begin(), end(), [&](const value_type &e) { return e.first == n; });
+        }
+
+        template <typename K> size_type count(const K &key) const { return find(key) != end(); }
+        template <typename K> bool contains(const K &key) const { return find(key) != end(); }
+        template <typename K> const PropertyValue &at(const K &key) const {
+            auto it = find(key);
+            if (it == end())
+                throw std::out_of_range("vectkit::PropertyMap::at: no such key");
+            return it->second;
+        }
+        template <typename K> PropertyValue &at(const K &key) {
+            return const_cast<PropertyValue &>(std::as_const(*this).at(key));
+        }
+
+        PropertyValue &operator[](const PropertyKey &key) {
+            auto it = find(key);
+            if (it != end())
+                return it->second;
+            PropertyValue &value = slot(key);
+            value = PropertyValue();
+            return value;
+        }
+        template <typename V> void insert_or_assign(const PropertyKey &key, V &&value) {
+            (*this)[key] = std::forward<V>(value);
+        }
+
+        template <typename K> size_type erase(const K &key) {
+            auto it = find(key);
+            if (it == end())
+                return 0;
+            std::rotate(it, it + 1, end()); // the entry is kept past the end for reuse
+            --size_;
+            return 1;
+        }
+        void clear() { size_ = 0; }
+
+        // Same entries, in any order
+        friend bool operator==(const PropertyMap &a, const PropertyMap &b) {
+            if (a.size() != b.size())
+                return false;
+            for (const auto &[key, value] : a) {
+                auto it = b.find(key);
+                if (it == b.end() || !(it->second == value))
+                    return false;
+            }
+            return true;
+        }
+
+      private:
+        friend class detail::FeatureDecoder;
+
+        // Appends an entry for a key not in the map yet. A reused entry's value still holds whatever
+        // it held before, for the caller to overwrite in place.
+        PropertyValue &slot(const PropertyKey &key) {
+            if (size_ == entries_.size())
+                entries_.emplace_back(key, PropertyValue());
+            else
+                entries_[size_].first = key;
+            return entries_[size_++].second;
+        }
+
+        std::vector<value_type> entries_;
+        size_type size_ = 0;
+    };
+
+    // A feature's properties: typed values as read (see PropertyValue). Copies share one immutable map,
+    // and a copy only gets its own on its first write, so all the features a Multi* geometry is split
+    // into hold a single set however many parts there are. An empty set allocates nothing.
+    //
+    // Sets read with ReadOptions::lazy_properties hold the raw JSON object instead, as a slice of the
+    // input that they keep alive, and decode it on first access (from any thread, exactly once).
+    class Properties {
+      public:
+        using Map = PropertyMap;
+        using key_type = Map::key_type;
+        using mapped_type = Map::mapped_type;
+        using value_type = Map::value_type;
+        using size_type = Map::size_type;
+        using const_iterator = Map::const_iterator;
+        using iterator = const_iterator;
+
+        Properties() = default;
+        Properties(Map map) {
+            if (!map.empty())
+                map_ = std::make_shared<Map>(std::move(map));
+        }
+        Properties(std::initializer_list<value_type> init) : Properties(Map(init)) {}
+        // Untyped properties, all taken as strings
+        Properties(const std::unordered_map<std::string, std::string> &strings) {
+            if (strings.empty())
+                return;
+            map_ = std::make_shared<Map>(strings.begin(), strings.end());
+        }
+
+        const Map &map() const {
+            if (lazy_)
+                return lazy_->get();
+            return map_ ? *map_ : empty_map();
+        }
+
+        bool empty() const { return map_ ? map_->empty() : !lazy_; } // a lazy set is never empty
+        size_type size() const { return map().size(); }
+        const_iterator begin() const { return map().begin(); }
+        const_iterator end() const { return map().end(); }
+        // Keys are a PropertyKey or a name
+        template <typename K> const_iterator find(const K &key) const { return map().find(key); }
+        template <typename K> size_type count(const K &key) const { return map().count(key); }
+        template <typename K> bool contains(const K &key) const { return map().contains(key); }
+        template <typename K> const PropertyValue &at(const K &key) const { return map().at(key); }
+
+        // Writes give this copy a map of its own first if another copy shares it
+        PropertyValue &operator[](const PropertyKey &key) { return writable()[key]; }
+        template <typename V> void insert_or_assign(const PropertyKey &key, V &&value) {
+            writable().insert_or_assign(key, std::forward<V>(value));
+        }
+        template <typename K> size_type erase(const K &key) { return contains(key) ? writable().erase(key) : 0; }
+        void clear() {
+            map_.reset();
+            lazy_.reset();
+        }
+
+        // Whether both refer to the same shared map
+        bool shares(const Properties &other) const {
+            return (map_ && map_ == other.map_) || (lazy_ && lazy_ == other.lazy_);
+        }
+
+        // False until a lazily read set is first accessed
+        bool decoded() const { return !lazy_ || lazy_->done.load(std::memory_order_acquire); }
+
+        friend bool operator==(const Properties &a, const Properties &b) {
+            return (a.map_ == b.map_ && a.lazy_ == b.lazy_) || a.map() == b.map();
+        }
+
+      private:
+        friend class detail::FeatureDecoder;
+
+        // A properties object not decoded yet. 'source' owns the input 'text' points into.
+        struct Lazy {
+            std::shared_ptr<const void> source;
+            std::string_view text;
+            void (*decode)(std::string_view, Map &) = nullptr;
+            std::once_flag once;
+            std::atomic<bool> done{false};
+            std::shared_ptr<Map> map;
+
+            const Map &get() {
+                std::call_once(once, [this] {
+                    auto m = std::make_shared<Map>();
+                    decode(text, *m);
+                    map = std::move(m);
+                    source.reset();
+                    done.store(true, std::memory_order_release);
+                });
+                return *map;
+            }
+        };
+
+        explicit Properties(std::shared_ptr<Map> map) : map_(std::move(map)) {}
+        explicit Properties(std::shared_ptr<Lazy> lazy) : lazy_(std::move(lazy)) {}
+
+        static const Map &empty_map() {
+            static const Map empty;
+            return empty;
+        }
+
+        Map &writable() {
+            if (lazy_) {
+                lazy_->get();
+                map_ = lazy_->map; // copied below unless this was the only reference
+                lazy_.reset();
+            }
+            if (!map_)
+                map_ = std::make_shared<Map>();
+            else if (map_.use_count() > 1)
+                map_ = std::make_shared<Map>(*map_);
+            return *map_;
+        }
+
+        std::shared_ptr<Map> map_;
+        std::shared_ptr<Lazy> lazy_;
+    };
+
     struct Feature {
         Geometry geometry;
-        std::unordered_map<std::string, std::string> properties;
+        Properties properties;
     };
 
     struct FeatureCollection {
         dp::Geo datum;
         dp::Euler heading;
         std::vector<Feature> features; // All geometries stored in Point (ENU/local) coordinates
-        std::unordered_map<std::string, std::string> global_properties; // Global properties for the collection
+        PropertyMap global_properties; // Global properties for the collection, in file order
     };
 
 } // namespace vectkit
+
+template <> struct std::hash<vectkit::PropertyKey> {
+    size_t operator()(const vectkit::PropertyKey &key) const noexcept {
+        if (!key.interned())
+            return std::hash<std::string_view>()(key.name());
+        return std::hash<std::uintptr_t>()(key.bits_);
+    }
+};
@@ -1,13 +1,41 @@
 #pragma once
 
+#include "batch.hpp"
 #include "parser.hpp"
+#include "seq.hpp"
+#include "stream.hpp"
 #include "types.hpp"
 #include "writter.hpp"
 
+#include <concepts>
+
 namespace vectkit {
 
     inline FeatureCollection read(const std::filesystem::path &file) { return ReadFeatureCollection(file); }
 
+    inline FeatureCollection read(const std::filesystem::path &file, const ReadOptions &options) {
+        return ReadFeatureCollection(file, options);
+    }
+
+    // Streaming read: on_feature(Feature &&) is called once per feature, and only the returned header
+    // (datum, heading, global properties) is kept
+    template <typename Callback>
+        requires std::invocable<Callback &, Feature &&>
+    FeatureCollection read(const std::filesystem::path &file, Callback &&on_feature) {
+        return ReadFeatures(file, std::forward<Callback>(on_feature));
+    }
+
+    // Many files at once, results in input order; a failed file carries its error instead of throwing
+    inline std::vector<FileResult> read_all(std::span<const std::filesystem::path> files,
+                                            const BatchOptions &options = {}) {
+        return ReadFeatureCollections(files, options);
+    }
+
+    inline std::vector<FileResult> read_all(const std::filesystem::path &directory, std::string_view pattern,
+                                            const BatchOptions &options = {}) {
+        return ReadFeatureCollections(directory, pattern, options);
+    }
+
     inline void write(const FeatureCollection &fc, const std::filesystem::path &outPath, CRS outputCrs) {
         WriteFeatureCollection(fc, outPath, outputCrs);
     }
@@ -16,6 +44,25 @@ namespace vectkit {
         WriteFeatureCollection(fc, outPath);
     }
 
+    inline void write(const FeatureCollection &fc, const std::filesystem::path &outPath, const WriteOptions &options) {
+        WriteFeatureCollection(fc, outPath, options);
+    }
+
+    // GeoJSON text sequences (RFC 8142), e.g. append-only logs
+    inline FeatureCollection read_seq(const std::filesystem::path &file, const ReadOptions &options = {}) {
+        return ReadFeatureSeq(file, options);
+    }
+
+    inline void write_seq(const FeatureCollection &fc, const std::filesystem::path &outPath,
+                          CRS outputCrs = CRS::WGS) {
+        WriteFeatureSeq(fc, outPath, outputCrs);
+    }
+
+    inline void write_seq(const FeatureCollection &fc, const std::filesystem::path &outPath,
+                          const WriteOptions &options) {
+        WriteFeatureSeq(fc, outPath, options);
+    }
+
 } // namespace vectkit
 
 namespace vk = vectkit;
@@ -13,10 +13,10 @@ namespace vectkit {
 
     struct Element {
         Geometry geometry;
-        std::unordered_map<std::string, std::string> properties;
+        Properties::Map properties;
         std::string type;
 
-        Element(const Geometry &geom, const std::unordered_map<std::string, std::string> &props = {},
+        Element(const Geometry &geom, const Properties::Map &props = {},
                 const std::string &elem_type = "")
             : geometry(geom), properties(props), type(elem_type) {}
     };
@@ -24,14 +24,14 @@ namespace vectkit {
     class Vector {
       private:
         dp::Polygon field_boundary_;
-        std::unordered_map<std::string, std::string> field_properties_;
+        Properties::Map field_properties_;
         std::vector<Element> elements_;
 
         dp::Geo datum_;
         dp::Euler heading_;
         CRS crs_;
 
-        std::unordered_map<std::string, std::string> global_properties_;
+        Properties::Map global_properties_;
 
       public:
         Vector() = delete;
@@ -41,19 +41,20 @@ namespace vectkit {
             : field_boundary_(field_boundary), datum_(datum), heading_(heading), crs_(crs) {}
 
         static Vector fromFile(const std::filesystem::path &path) {
+            static const PropertyKey type_key("type");
             auto fc = vectkit::read(path);
 
             if (fc.features.empty()) {
                 throw std::runtime_error("Vector::fromFile: No features found in file");
             }
 
-            std::optional<std::pair<dp::Polygon, std::unordered_map<std::string, std::string>>> field_data;
+            std::optional<std::pair<dp::Polygon, Properties::Map>> field_data;
 
             for (const auto &feature : fc.features) {
                 if (std::holds_alternative<dp::Polygon>(feature.geometry)) {
-                    auto it = feature.properties.find("type");
+                    auto it = feature.properties.find(type_key);
                     if (it != feature.properties.end() && it->second == "field") {
-                        field_data = std::make_pair(std::get<dp::Polygon>(feature.geometry), feature.properties);
+                        field_data = std::make_pair(std::get<dp::Polygon>(feature.geometry), feature.properties.map());
                         break;
                     }
                 }
@@ -62,7 +63,7 @@ namespace vectkit {
             if (!field_data) {
                 for (const auto &feature : fc.features) {
                     if (std::holds_alternative<dp::Polygon>(feature.geometry)) {
-                        field_data = std::make_pair(std::get<dp::Polygon>(feature.geometry), feature.properties);
+                        field_data = std::make_pair(std::get<dp::Polygon>(feature.geometry), feature.properties.map());
                         break;
                     }
                 }
@@ -77,16 +78,16 @@ namespace vectkit {
             vector.global_properties_ = fc.global_properties;
 
             for (const auto &feature : fc.features) {
-                auto type_it = feature.properties.find("type");
+                auto type_it = feature.properties.find(type_key);
                 bool isExplicitField = (type_it != feature.properties.end() && type_it->second == "field");
 
                 if (!isExplicitField) {
                     std::string elem_type = "unknown";
                     if (type_it != feature.properties.end()) {
-                        elem_type = type_it->second;
+                        elem_type = type_it->second.text();
                     }
 
-                    vector.elements_.emplace_back(feature.geometry, feature.properties, elem_type);
+                    vector.elements_.emplace_back(feature.geometry, feature.properties.map(), elem_type);
                 }
             }
 
@@ -114,9 +115,9 @@ namespace vectkit {
 
         void setFieldBoundary(const dp::Polygon &boundary) { field_boundary_ = boundary; }
 
-        const std::unordered_map<std::string, std::string> &getFieldProperties() const { return field_properties_; }
+        const Properties::Map &getFieldProperties() const { return field_properties_; }
 
-        void setFieldProperty(const std::string &key, const std::string &value) { field_properties_[key] = value; }
+        void setFieldProperty(const std::string &key, const PropertyValue &value) { field_properties_[key] = value; }
 
         void removeFieldProperty(const std::string &key) { field_properties_.erase(key); }
 
@@ -139,7 +140,7 @@ namespace vectkit {
         }
 
         void addElement(const Geometry &geometry, const std::string &type = "",
-                        const std::unordered_map<std::string, std::string> &properties = {}) {
+                        const Properties::Map &properties = {}) {
             auto props = properties;
             if (!type.empty()) {
                 props["type"] = type;
@@ -154,22 +155,22 @@ namespace vectkit {
         }
 
         void addPoint(const dp::Point &point, const std::string &type = "point",
-                      const std::unordered_map<std::string, std::string> &properties = {}) {
+                      const Properties::Map &properties = {}) {
             addElement(point, type, properties);
         }
 
         void addLine(const dp::Segment &line, const std::string &type = "line",
-                     const std::unordered_map<std::string, std::string> &properties = {}) {
+                     const Properties::Map &properties = {}) {
             addElement(line, type, properties);
         }
 
         void addPath(const std::vector<dp::Point> &path, const std::string &type = "path",
-                     const std::unordered_map<std::string, std::string> &properties = {}) {
+                     const Properties::Map &properties = {}) {
             addElement(path, type, properties);
         }
 
         void addPolygon(const dp::Polygon &polygon, const std::string &type = "polygon",
-                        const std::unordered_map<std::string, std::string> &properties = {}) {
+                        const Properties::Map &properties = {}) {
             addElement(polygon, type, properties);
         }
 
@@ -246,14 +247,16 @@ namespace vectkit {
 
         void setCRS(CRS crs) { crs_ = crs; }
 
-        void setGlobalProperty(const std::string &key, const std::string &value) { global_properties_[key] = value; }
+        void setGlobalProperty(const std::string &key, PropertyValue value) {
+            global_properties_[key] = std::move(value);
+        }
 
         std::string getGlobalProperty(const std::string &key, const std::string &default_value = "") const {
             auto it = global_properties_.find(key);
-            return (it != global_properties_.end()) ? it->second : default_value;
+            return (it != global_properties_.end()) ? it->second.text() : default_value;
         }
 
-        const std::unordered_map<std::string, std::string> &getGlobalProperties() const { return global_properties_; }
+        const Properties::Map &getGlobalProperties() const { return global_properties_; }
 
         void removeGlobalProperty(const std::string &key) { global_properties_.erase(key); }
 
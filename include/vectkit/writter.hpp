@@ -1,172 +1,678 @@
 #pragma once
 
+#include "vectkit/compress.hpp"
+#include "vectkit/io.hpp"
+#include "vectkit/pool.hpp"
 #include "vectkit/types.hpp"
 
+#include <algorithm>
+#include <charconv>
 #include <cmath>
+#include <concepts>
+#include <exception>
 #include <filesystem>
-#include <fstream>
-#include <iomanip>
-#include <sstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace vectkit {
 
+    struct WriteOptions {
+        // CRS the coordinates are written in
+        CRS crs = CRS::WGS;
+
+        // Threads serializing features (0 = one per hardware thread). The output is the same for any value.
+        size_t threads = 1;
+
+        // Decimal places coordinates are rounded to, per CRS, e.g. 3 (1 mm) for ENU metres and 8 (about
+        // 1 mm) for WGS degrees; at most 15. Negative writes the shortest text that reads back as the
+        // same double. WGS altitudes are always whole metres, and the datum and heading are always exact.
+        int enu_decimals = -1;
+        int wgs_decimals = -1;
+    };
+
     namespace detail {
+        // How coordinates are written: the CRS and the decimal places for it
+        struct OutputFormat {
+            vectkit::CRS crs = vectkit::CRS::WGS;
+            int decimals = -1;
+
+            OutputFormat(vectkit::CRS c) : crs(c) {}
+
+            explicit OutputFormat(const WriteOptions &options)
+                : crs(options.crs), decimals(options.crs == vectkit::CRS::ENU ? options.enu_decimals
+                                                                               : options.wgs_decimals) {
+                if (decimals > 15)
+                    throw std::invalid_argument("vectkit::WriteOptions: at most 15 decimal places, got " +
+                                                std::to_string(decimals));
+            }
+        };
+
         // Helper to escape a string for JSON
         inline std::string escape_string(const std::string &s) {
             std::string result;
             result.reserve(s.size() + 2);
-            for (char c : s) {
-                switch (c) {
-                case '"':
-                    result += "\\\"";
-                    break;
-                case '\\':
-                    result += "\\\\";
-                    break;
-                case '\b':
-                    result += "\\b";
-                    break;
-                case '\f':
-                    result += "\\f";
-                    break;
-                case '\n':
-                    result += "\\n";
-                    break;
-                case '\r':
-                    result += "\\r";
-                    break;
-                case '\t':
-                    result += "\\t";
-                    break;
-                default:
-                    result += c;
-                    break;
+            append_escaped(result, s);
+            return result;
+        }
+
+        // Shortest text that reads back as the same double, formatted straight into out. Non-finite
+        // values, which JSON cannot hold, become null.
+        inline void append_number(std::string &out, double v) {
+            if (!std::isfinite(v)) {
+                out += "null";
+                return;
+            }
+            size_t at = out.size();
+            out.resize(at + 32);
+            char *end = std::to_chars(out.data() + at, out.data() + out.size(), v).ptr;
+            out.resize(static_cast<size_t>(end - out.data()));
+        }
+
+        // std::to_chars' fixed form of v with 'decimals' places (0-15): the exact value of v correctly
+        // rounded, trailing zeros dropped, and no negative zero
+        inline void append_fixed_exact(std::string &out, double v, int decimals) {
+            char buf[400];
+            char *end = std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::fixed, decimals).ptr;
+            if (decimals > 0) {
+                while (end[-1] == '0')
+                    --end;
+                if (end[-1] == '.')
+                    --end;
+            }
+            const char *begin = buf;
+            if (end - buf == 2 && buf[0] == '-' && buf[1] == '0')
+                ++begin;
+            out.append(begin, static_cast<size_t>(end - begin));
+        }
+
+        // v rounded to 'decimals' places (0-15), trailing zeros dropped; the same text as
+        // append_fixed_exact. Up to 8 places, v is scaled to a fixed-point integer and printed with
+        // integer conversions, which is much cheaper than general float formatting. The scaling rounds
+        // once, by at most half an ulp, so it is only trusted when the scaled value is further than that
+        // from a rounding tie; ties, near-ties, more places and values too large for an exact integer
+        // take std::to_chars instead.
+        inline void append_fixed(std::string &out, double v, int decimals) {
+            static constexpr double scale[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+            constexpr int max_fast_decimals = 8;
+            if (!std::isfinite(v)) {
+                out += "null";
+                return;
+            }
+            if (decimals > max_fast_decimals) {
+                append_fixed_exact(out, v, decimals);
+                return;
+            }
+            double product = v * scale[decimals];
+            double scaled = std::round(product);
+            double margin = std::fabs(product) * 0x1p-52; // at least half an ulp of product
+            if (std::fabs(scaled) >= 9007199254740992.0 || // 2^53: no longer an exact integer
+                std::fabs(std::fabs(product - scaled) - 0.5) <= margin) {
+                append_fixed_exact(out, v, decimals);
+                return;
+            }
+
+            auto n = static_cast<std::int64_t>(scaled);
+            if (n < 0) {
+                out += '-';
+                n = -n;
+            }
+            auto unit = static_cast<std::uint64_t>(scale[decimals]);
+            auto whole = static_cast<std::uint64_t>(n) / unit;
+            auto frac = static_cast<std::uint64_t>(n) % unit;
+
+            char buf[40];
+            char *end = std::to_chars(buf, buf + 20, whole).ptr;
+            if (frac != 0) {
+                int digits = decimals;
+                while (frac % 10 == 0) {
+                    frac /= 10;
+                    --digits;
                 }
+                *end++ = '.';
+                for (char *d = end + digits - 1; d >= end; --d, frac /= 10)
+                    *d = static_cast<char>('0' + frac % 10);
+                end += digits;
             }
-            return result;
+            out.append(buf, static_cast<size_t>(end - buf));
         }
 
-        // Helper to build a JSON array of coordinates
-        inline std::string coords_to_json(double x, double y, double z, bool round_z = false) {
-            std::ostringstream oss;
-            oss << "[" << std::setprecision(15) << x << "," << y << ",";
+        inline void append_coord(std::string &out, double v, int decimals) {
+            if (decimals < 0)
+                append_number(out, v);
+            else
+                append_fixed(out, v, decimals);
+        }
+
+        inline void append_coords(std::string &out, double x, double y, double z, bool round_z = false,
+                                  int decimals = -1) {
+            out += '[';
+            append_coord(out, x, decimals);
+            out += ',';
+            append_coord(out, y, decimals);
+            out += ',';
             if (round_z) {
-                oss << static_cast<int>(std::round(z));
+                char buf[16];
+                char *end = std::to_chars(buf, buf + sizeof(buf), static_cast<int>(std::round(z))).ptr;
+                out.append(buf, static_cast<size_t>(end - buf));
             } else {
-                oss << std::setprecision(15) << z;
+                append_coord(out, z, decimals);
             }
-            oss << "]";
-            return oss.str();
+            out += ']';
         }
-    } // namespace detail
 
-    inline std::string geometryToJson(Geometry const &geom, const dp::Geo &datum, vectkit::CRS outputCrs) {
-        auto ptCoords = [&](dp::Point const &p) -> std::string {
-            if (outputCrs == vectkit::CRS::ENU) {
-                return detail::coords_to_json(p.x, p.y, p.z);
+        // Helper to build a JSON array of coordinates
+        inline std::string coords_to_json(double x, double y, double z, bool round_z = false) {
+            std::string out;
+            append_coords(out, x, y, z, round_z);
+            return out;
+        }
+
+        inline void append_point(std::string &out, dp::Point const &p, const dp::Geo &datum,
+                                 const OutputFormat &format) {
+            if (format.crs == vectkit::CRS::ENU) {
+                append_coords(out, p.x, p.y, p.z, false, format.decimals);
             } else {
                 concord::frame::ENU enu{p, datum};
                 auto wgs = concord::frame::to_wgs(enu);
-                return detail::coords_to_json(wgs.longitude, wgs.latitude, wgs.altitude, true);
+                append_coords(out, wgs.longitude, wgs.latitude, wgs.altitude, true, format.decimals);
             }
-        };
+        }
 
-        return std::visit(
-            [&](auto const &shape) -> std::string {
-                using T = std::decay_t<decltype(shape)>;
-                std::ostringstream oss;
-
-                if constexpr (std::is_same_v<T, dp::Point>) {
-                    oss << R"({"type":"Point","coordinates":)" << ptCoords(shape) << "}";
-                } else if constexpr (std::is_same_v<T, dp::Segment>) {
-                    oss << R"({"type":"LineString","coordinates":[)" << ptCoords(shape.start) << ","
-                        << ptCoords(shape.end) << "]}";
-                } else if constexpr (std::is_same_v<T, std::vector<dp::Point>>) {
-                    oss << R"({"type":"LineString","coordinates":[)";
-                    bool first = true;
-                    for (auto const &p : shape) {
-                        if (!first)
-                            oss << ",";
-                        first = false;
-                        oss << ptCoords(p);
-                    }
-                    oss << "]}";
-                } else if constexpr (std::is_same_v<T, dp::Polygon>) {
-                    oss << R"({"type":"Polygon","coordinates":[[)";
-                    bool first = true;
-                    for (auto const &p : shape.vertices) {
-                        if (!first)
-                            oss << ",";
-                        first = false;
-                        oss << ptCoords(p);
+        template <typename Points>
+        void append_points(std::string &out, Points const &points, const dp::Geo &datum, const OutputFormat &format) {
+            bool first = true;
+            for (auto const &p : points) {
+                if (!first)
+                    out += ',';
+                first = false;
+                append_point(out, p, datum, format);
+            }
+        }
+
+        // Parts [first, last) of a flat multi-part buffer, each as an array of positions
+        inline void append_parts(std::string &out, std::vector<dp::Point> const &points,
+                                 std::vector<std::uint32_t> const &ends, size_t first, size_t last,
+                                 const dp::Geo &datum, const OutputFormat &format) {
+            for (size_t i = first; i < last; ++i) {
+                if (i > first)
+                    out += ',';
+                out += '[';
+                append_points(out, part(points, ends, i), datum, format);
+                out += ']';
+            }
+        }
+
+        inline void append_geometry(std::string &out, Geometry const &geom, const dp::Geo &datum,
+                                    const OutputFormat &format) {
+            std::visit(
+                [&](auto const &shape) {
+                    using T = std::decay_t<decltype(shape)>;
+
+                    if constexpr (std::is_same_v<T, dp::Point>) {
+                        out += R"({"type":"Point","coordinates":)";
+                        append_point(out, shape, datum, format);
+                        out += '}';
+                    } else if constexpr (std::is_same_v<T, dp::Segment>) {
+                        out += R"({"type":"LineString","coordinates":[)";
+                        append_point(out, shape.start, datum, format);
+                        out += ',';
+                        append_point(out, shape.end, datum, format);
+                        out += "]}";
+                    } else if constexpr (std::is_same_v<T, std::vector<dp::Point>>) {
+                        out += R"({"type":"LineString","coordinates":[)";
+                        append_points(out, shape, datum, format);
+                        out += "]}";
+                    } else if constexpr (std::is_same_v<T, dp::Polygon>) {
+                        out += R"({"type":"Polygon","coordinates":[[)";
+                        append_points(out, shape.vertices, datum, format);
+                        out += "]]}";
+                    } else if constexpr (std::is_same_v<T, MultiPoint>) {
+                        out += R"({"type":"MultiPoint","coordinates":[)";
+                        append_points(out, shape.points, datum, format);
+                        out += "]}";
+                    } else if constexpr (std::is_same_v<T, MultiLineString>) {
+                        out += R"({"type":"MultiLineString","coordinates":[)";
+                        append_parts(out, shape.points, shape.lines, 0, shape.lines.size(), datum, format);
+                        out += "]}";
+                    } else if constexpr (std::is_same_v<T, PolygonWithHoles>) {
+                        out += R"({"type":"Polygon","coordinates":[)";
+                        append_parts(out, shape.points, shape.rings, 0, shape.rings.size(), datum, format);
+                        out += "]}";
+                    } else if constexpr (std::is_same_v<T, MultiPolygon>) {
+                        out += R"({"type":"MultiPolygon","coordinates":[)";
+                        for (size_t i = 0; i < shape.size(); ++i) {
+                            if (i > 0)
+                                out += ',';
+                            auto [first, last] = shape.polygon(i);
+                            out += '[';
+                            append_parts(out, shape.points, shape.rings, first, last, datum, format);
+                            out += ']';
+                        }
+                        out += "]}";
                     }
-                    oss << "]]}";
-                }
-                return oss.str();
-            },
-            geom);
+                },
+                geom);
+        }
+
+        // Strings quoted, raw JSON as it is, numbers in their shortest round-trip form
+        inline void append_value(std::string &out, PropertyValue const &value) {
+            switch (value.type()) {
+            case PropertyValue::Type::String:
+                out += '"';
+                append_escaped(out, value.as_string());
+                out += '"';
+                break;
+            case PropertyValue::Type::Raw:
+                out += value.as_raw();
+                break;
+            default:
+                out += value.text();
+                break;
+            }
+        }
+
+        inline void append_feature(std::string &out, Feature const &f, const dp::Geo &datum,
+                                   const OutputFormat &format) {
+            out += R"({"type":"Feature","properties":{)";
+
+            bool first = true;
+            for (auto const &kv : f.properties) {
+                if (!first)
+                    out += ',';
+                first = false;
+                out += '"';
+                append_escaped(out, kv.first.name());
+                out += "\":";
+                append_value(out, kv.second);
+            }
+
+            out += R"(},"geometry":)";
+            append_geometry(out, f.geometry, datum, format);
+            out += '}';
+        }
+
+        // The collection's 'properties' object: crs, datum, heading, then the global properties
+        inline void append_header(std::string &out, FeatureCollection const &fc, vectkit::CRS outputCrs) {
+            out += '{';
+
+            // CRS
+            if (outputCrs == vectkit::CRS::WGS) {
+                out += R"("crs":"EPSG:4326")";
+            } else {
+                out += R"("crs":"ENU")";
+            }
+
+            // Datum - GeoJSON uses [longitude, latitude, altitude] order
+            out += R"(,"datum":[)";
+            append_number(out, fc.datum.longitude);
+            out += ',';
+            append_number(out, fc.datum.latitude);
+            out += ',';
+            append_number(out, fc.datum.altitude);
+            out += ']';
+
+            // Heading
+            out += R"(,"heading":)";
+            append_number(out, fc.heading.yaw);
+
+            // Global properties, typed like feature properties
+            for (const auto &[key, value] : fc.global_properties) {
+                out += ",\"";
+                append_escaped(out, key.name());
+                out += "\":";
+                append_value(out, value);
+            }
+            out += '}';
+        }
+
+        inline void append_collection_head(std::string &out, FeatureCollection const &fc, vectkit::CRS outputCrs) {
+            out += R"({"type":"FeatureCollection","properties":)";
+            append_header(out, fc, outputCrs);
+            out += R"(,"features":[)";
+        }
+
+        inline void append_collection(std::string &out, FeatureCollection const &fc, const OutputFormat &format) {
+            append_collection_head(out, fc, format.crs);
+
+            bool first = true;
+            for (auto const &f : fc.features) {
+                if (!first)
+                    out += ',';
+                first = false;
+                append_feature(out, f, fc.datum, format);
+            }
+
+            out += "]}";
+        }
+
+        // Builds the text of items [0, count) on up to 'threads' threads, append(std::string &, i) adding
+        // item i to a chunk. Work goes out in batches of two chunks per thread; each batch's chunk texts
+        // are passed to emit(std::span<const std::string>) in order, and their buffers are reused for the
+        // next batch. Chunks are sized from the items serialized so far to about chunk_bytes each, so
+        // memory stays near 2 * threads * chunk_bytes. The threads are started once for the whole call.
+        template <typename Append, typename Emit>
+        void serialize_items(size_t count, size_t threads, size_t chunk_bytes, std::vector<std::string> &chunks,
+                             Append &&append, Emit &&emit) {
+            threads = resolve_threads(threads);
+            chunks.resize(threads * 2);
+            ThreadGroup group(std::min(threads, count));
+            size_t per_chunk = 16; // until the first batch shows how large the items are
+            size_t seen = 0, seen_bytes = 0;
+            for (size_t pos = 0; pos < count;) {
+                size_t batch = std::min(chunks.size(), (count - pos + per_chunk - 1) / per_chunk);
+                group.run(batch, [&](size_t k) {
+                    std::string &out = chunks[k];
+                    out.clear();
+                    size_t first = pos + k * per_chunk;
+                    size_t last = std::min(first + per_chunk, count);
+                    for (size_t i = first; i < last; ++i)
+                        append(out, i);
+                });
+                size_t next = std::min(pos + batch * per_chunk, count);
+                for (size_t k = 0; k < batch; ++k)
+                    seen_bytes += chunks[k].size();
+                seen += next - pos;
+                pos = next;
+                emit(std::span<const std::string>(chunks.data(), batch));
+                per_chunk = std::max<size_t>(1, chunk_bytes * seen / std::max<size_t>(seen_bytes, 1));
+            }
+        }
+
+        // serialize_items for the members of a features array: each feature preceded by a comma unless
+        // it is the first one and 'after_first' is false
+        template <typename Emit>
+        void serialize_features(std::span<const Feature> features, bool after_first, const dp::Geo &datum,
+                                const OutputFormat &format, size_t threads, size_t chunk_bytes,
+                                std::vector<std::string> &chunks, Emit &&emit) {
+            serialize_items(
+                features.size(), threads, chunk_bytes, chunks,
+                [&](std::string &out, size_t i) {
+                    if (i > 0 || after_first)
+                        out += ',';
+                    append_feature(out, features[i], datum, format);
+                },
+                std::forward<Emit>(emit));
+        }
+    } // namespace detail
+
+    // Append the text of one geometry or feature to out, e.g. while building a larger message around it.
+    // Points are formatted straight into out; nothing is allocated once out has room.
+    inline void write_geometry(std::string &out, Geometry const &geom, const dp::Geo &datum, vectkit::CRS outputCrs) {
+        detail::append_geometry(out, geom, datum, outputCrs);
+    }
+
+    inline void write_feature(std::string &out, Feature const &f, const dp::Geo &datum, vectkit::CRS outputCrs) {
+        detail::append_feature(out, f, datum, outputCrs);
+    }
+
+    inline std::string geometryToJson(Geometry const &geom, const dp::Geo &datum, vectkit::CRS outputCrs) {
+        std::string out;
+        detail::append_geometry(out, geom, datum, outputCrs);
+        return out;
     }
 
     inline std::string featureToJson(Feature const &f, const dp::Geo &datum, vectkit::CRS outputCrs) {
-        std::ostringstream oss;
-        oss << R"({"type":"Feature","properties":{)";
+        std::string out;
+        detail::append_feature(out, f, datum, outputCrs);
+        return out;
+    }
+
+    inline std::string toJson(FeatureCollection const &fc, vectkit::CRS outputCrs) {
+        std::string out;
+        detail::append_collection(out, fc, outputCrs);
+        return out;
+    }
 
-        bool first = true;
-        for (auto const &kv : f.properties) {
-            if (!first)
-                oss << ",";
-            first = false;
-            oss << "\"" << detail::escape_string(kv.first) << "\":\"" << detail::escape_string(kv.second) << "\"";
+    // Serializes fc into a caller-owned buffer, replacing its contents. The buffer keeps its capacity,
+    // so reusing one across calls (e.g. per request or message) stops allocating once it has grown.
+    inline void write_to_buffer(FeatureCollection const &fc, std::string &out,
+                                vectkit::CRS outputCrs = vectkit::CRS::WGS) {
+        out.clear();
+        detail::append_collection(out, fc, outputCrs);
+    }
+
+    // Same text, with features serialized on options.threads threads
+    inline void write_to_buffer(FeatureCollection const &fc, std::string &out, const WriteOptions &options) {
+        detail::OutputFormat format(options);
+        out.clear();
+        if (detail::resolve_threads(options.threads) <= 1) {
+            detail::append_collection(out, fc, format);
+            return;
         }
+        detail::append_collection_head(out, fc, options.crs);
+        std::vector<std::string> chunks;
+        detail::serialize_features(fc.features, false, fc.datum, format, options.threads, size_t(1) << 20, chunks,
+                                   [&](std::span<const std::string> parts) {
+                                       for (const auto &part : parts)
+                                           out += part;
+                                   });
+        out += "]}";
+    }
 
-        oss << "}," << R"("geometry":)" << geometryToJson(f.geometry, datum, outputCrs) << "}";
-        return oss.str();
+    inline std::string write_to_string(FeatureCollection const &fc, vectkit::CRS outputCrs = vectkit::CRS::WGS) {
+        return toJson(fc, outputCrs);
     }
 
-    inline std::string toJson(FeatureCollection const &fc, vectkit::CRS outputCrs) {
-        std::ostringstream oss;
-        oss << R"({"type":"FeatureCollection","properties":{)";
+    // Hands the text of fc to sink(std::string_view) in pieces of about chunk_size bytes, e.g. to a socket,
+    // a pipe or a ring buffer. The pieces are built in one buffer reused for the whole collection (one
+    // per thread with options.threads), so memory does not grow with fc and no string is made per
+    // feature. Each view is only valid during its call. Together the pieces are write_to_buffer's text.
+    template <typename Sink>
+        requires std::invocable<Sink &, std::string_view>
+    void write_to_sink(FeatureCollection const &fc, Sink &&sink, const WriteOptions &options = {},
+                       size_t chunk_size = size_t(1) << 16) {
+        detail::OutputFormat format(options);
+        std::string buf;
+        buf.reserve(chunk_size + chunk_size / 8);
+        auto flush = [&] {
+            if (!buf.empty())
+                sink(std::string_view(buf));
+            buf.clear();
+        };
 
-        // CRS
-        if (outputCrs == vectkit::CRS::WGS) {
-            oss << R"("crs":"EPSG:4326")";
+        detail::append_collection_head(buf, fc, options.crs);
+        if (detail::resolve_threads(options.threads) <= 1) {
+            for (size_t i = 0; i < fc.features.size(); ++i) {
+                if (i > 0)
+                    buf += ',';
+                detail::append_feature(buf, fc.features[i], fc.datum, format);
+                if (buf.size() >= chunk_size)
+                    flush();
+            }
         } else {
-            oss << R"("crs":"ENU")";
+            flush();
+            std::vector<std::string> chunks;
+            detail::serialize_features(fc.features, false, fc.datum, format, options.threads, chunk_size,
+                                       chunks, [&](std::span<const std::string> parts) {
+                                           for (const auto &part : parts)
+                                               sink(std::string_view(part));
+                                       });
+        }
+        buf += "]}";
+        flush();
+    }
+
+    // Writes the text of fc to an open file descriptor (a file, pipe or socket) the caller keeps owning
+    inline void write_to_fd(FeatureCollection const &fc, int fd, const WriteOptions &options = {}) {
+        write_to_sink(fc, [fd](std::string_view data) { detail::write_fd(fd, data); }, options, size_t(1) << 20);
+    }
+
+    namespace detail {
+        // An output file fed in large chunks: written straight to its descriptor, or through a gzip or
+        // zstd compressor if the path ends in .gz or .zst. Text is gathered in buffer() and handed over
+        // by commit() once it reaches the flush size, so memory stays at about one flush whatever the
+        // total size of the output.
+        class OutputFile {
+          public:
+            OutputFile(std::filesystem::path const &outPath, const char *who, size_t flush_size)
+                : flush_size_(flush_size) {
+                Compression c = compression_for(outPath);
+                if (!compression_available(c))
+                    compression_unavailable(c, std::string(who) + ": \"" + outPath.string() + '\"');
+                if (!file_.open(outPath))
+                    throw std::runtime_error("Cannot open for write: " + outPath.string());
+                if (c != Compression::None)
+                    compressed_.emplace(file_, c, std::string(who) + ": \"" + outPath.string() + '\"');
+                buf_.reserve(flush_size + flush_size / 8);
+            }
+
+            std::string &buffer() { return buf_; }
+
+            void commit() {
+                if (buf_.size() >= flush_size_)
+                    flush();
+            }
+
+            // Writes the buffer, then parts back to back without copying them into it
+            void write_parts(std::span<const std::string> parts) {
+                flush();
+                if (compressed_) {
+                    for (const auto &part : parts)
+                        compressed_->write(part);
+                } else {
+                    file_.write_parts(parts);
+                }
+            }
+
+            // Writes what is left and closes the file; its errors are reported here rather than lost
+            void close() {
+                flush();
+                if (compressed_)
+                    compressed_->finish();
+                file_.close();
+            }
+
+          private:
+            void flush() {
+                if (buf_.empty())
+                    return;
+                if (compressed_)
+                    compressed_->write(buf_);
+                else
+                    file_.write(buf_);
+                buf_.clear();
+            }
+
+            FileSink file_;
+            std::optional<CompressedOutput> compressed_;
+            std::string buf_;
+            size_t flush_size_;
+        };
+    } // namespace detail
+
+    // Writes a FeatureCollection one feature at a time: the header (crs, datum, heading and global
+    // properties, taken from the collection given to the constructor, whose features are ignored) goes
+    // out first, then each feature passed to write(). Text is flushed to the file in buffer_size chunks,
+    // so a collection of any size, or features produced on the fly, can be written in constant memory.
+    // The file is the same as WriteFeatureCollection's.
+    //
+    // write_all() takes a whole range and, with options.threads other than 1, serializes it on several
+    // threads: each builds the text of a run of features in its own buffer, and the buffers go to the
+    // file in order with one writev, without being copied together. The file is the same either way.
+    //
+    // close() ends the document and reports any write error. A writer destroyed without it still ends the
+    // document, swallowing errors, unless a write failed or it is destroyed by an exception unwinding:
+    // then the file is left unterminated, so a reader reports it as truncated instead of taking the
+    // features written so far for the whole collection.
+    class FeatureWriter {
+      public:
+        FeatureWriter(std::filesystem::path const &outPath, FeatureCollection const &header,
+                      vectkit::CRS outputCrs = vectkit::CRS::WGS, size_t buffer_size = size_t(4) << 20)
+            : FeatureWriter(outPath, header, WriteOptions{.crs = outputCrs}, buffer_size) {}
+
+        FeatureWriter(std::filesystem::path const &outPath, FeatureCollection const &header,
+                      const WriteOptions &options, size_t buffer_size = size_t(4) << 20)
+            : out_(outPath, "vectkit::FeatureWriter()", buffer_size), datum_(header.datum), format_(options),
+              threads_(options.threads), buffer_size_(buffer_size) {
+            detail::append_collection_head(out_.buffer(), header, format_.crs);
         }
 
-        // Datum - GeoJSON uses [longitude, latitude, altitude] order
-        oss << "," << R"("datum":[)" << std::setprecision(15) << fc.datum.longitude << "," << fc.datum.latitude << ","
-            << fc.datum.altitude << "]";
+        FeatureWriter(const FeatureWriter &) = delete;
+        FeatureWriter &operator=(const FeatureWriter &) = delete;
 
-        // Heading
-        oss << "," << R"("heading":)" << std::setprecision(15) << fc.heading.yaw;
+        ~FeatureWriter() {
+            if (open_ && !failed_ && std::uncaught_exceptions() == uncaught_) {
+                try {
+                    close();
+                } catch (...) {
+                }
+            }
+        }
 
-        // Global properties
-        for (const auto &[key, value] : fc.global_properties) {
-            oss << ",\"" << detail::escape_string(key) << "\":\"" << detail::escape_string(value) << "\"";
+        void write(Feature const &f) {
+            try {
+                std::string &buf = out_.buffer();
+                if (count_ > 0)
+                    buf += ',';
+                detail::append_feature(buf, f, datum_, format_);
+                ++count_;
+                out_.commit();
+            } catch (...) {
+                failed_ = true;
+                throw;
+            }
         }
 
-        oss << "}," << R"("features":[)";
+        void write_all(std::span<const Feature> features) {
+            size_t threads = detail::resolve_threads(threads_);
+            if (threads <= 1 || features.size() < 2) {
+                for (auto const &f : features)
+                    write(f);
+                return;
+            }
+            // Two chunks per thread in flight, so about one buffer_size of text at a time
+            size_t chunk_bytes = std::max(buffer_size_ / (2 * threads), size_t(1) << 16);
+            try {
+                detail::serialize_features(features, count_ > 0, datum_, format_, threads, chunk_bytes, chunks_,
+                                           [&](std::span<const std::string> parts) { out_.write_parts(parts); });
+            } catch (...) {
+                failed_ = true;
+                throw;
+            }
+            count_ += features.size();
+        }
 
-        bool first = true;
-        for (auto const &f : fc.features) {
-            if (!first)
-                oss << ",";
-            first = false;
-            oss << featureToJson(f, fc.datum, outputCrs);
+        // Features written so far
+        size_t count() const { return count_; }
+
+        void close() {
+            if (!open_)
+                return;
+            open_ = false;
+            out_.buffer() += "]}\n";
+            out_.close();
         }
 
-        oss << "]}";
-        return oss.str();
+      private:
+        detail::OutputFile out_;
+        dp::Geo datum_;
+        detail::OutputFormat format_;
+        size_t threads_;
+        size_t buffer_size_;
+        std::vector<std::string> chunks_;
+        size_t count_ = 0;
+        bool open_ = true;
+        bool failed_ = false;                        // a write threw: the document is incomplete
+        int uncaught_ = std::uncaught_exceptions(); // exceptions in flight when the writer was made
+    };
+
+    inline void WriteFeatureCollection(FeatureCollection const &fc, std::filesystem::path const &outPath,
+                                       const WriteOptions &options) {
+        FeatureWriter writer(outPath, fc, options);
+        writer.write_all(fc.features);
+        writer.close();
     }
 
     inline void WriteFeatureCollection(FeatureCollection const &fc, std::filesystem::path const &outPath,
                                        vectkit::CRS outputCrs) {
-        std::string j = toJson(fc, outputCrs);
-        std::ofstream ofs(outPath);
-        if (!ofs)
-            throw std::runtime_error("Cannot open for write: " + outPath.string());
-        ofs << j << "\n";
+        WriteFeatureCollection(fc, outPath, WriteOptions{.crs = outputCrs});
     }
 
     inline void WriteFeatureCollection(FeatureCollection const &fc, std::filesystem::path const &outPath) {
@@ -0,0 +1,70 @@
+#include <doctest/doctest.h>
+
+#include "vectkit/vectkit.hpp"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    void write_file(const std::filesystem::path &path, const std::string &content) {
+        std::ofstream ofs(path);
+        ofs << content;
+    }
+} // namespace
+
+TEST_CASE("Batch - Results in input order") {
+    const std::filesystem::path wur = PROJECT_DIR "/misc/wur.geojson";
+    const std::filesystem::path field = PROJECT_DIR "/misc/field4.geojson";
+    auto one = vectkit::ReadFeatureCollection(wur);
+    auto two = vectkit::ReadFeatureCollection(field);
+
+    std::vector<std::filesystem::path> paths;
+    for (int i = 0; i < 20; ++i)
+        paths.push_back(i % 2 ? field : wur);
+
+    for (size_t threads : {size_t(1), size_t(4), size_t(0)}) {
+        auto results = vectkit::read_all(paths, {.threads = threads});
+        REQUIRE(results.size() == paths.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+            CHECK(results[i].ok());
+            CHECK(results[i].path == paths[i]);
+            const auto &expected = i % 2 ? two : one;
+            CHECK(vectkit::write_to_string(results[i].collection) == vectkit::write_to_string(expected));
+        }
+    }
+
+    CHECK(vectkit::read_all(std::vector<std::filesystem::path>{}).empty());
+}
+
+TEST_CASE("Batch - Errors stay with their file") {
+    const std::filesystem::path bad = "/tmp/test_batch_bad.geojson";
+    write_file(bad, R"({"type": "FeatureCollection", "features": []})");
+
+    std::vector<std::filesystem::path> paths{PROJECT_DIR "/misc/wur.geojson", "/nonexistent/file.geojson", bad,
+                                             PROJECT_DIR "/misc/field4.geojson"};
+    auto results = vectkit::read_all(paths, {.threads = 2});
+    REQUIRE(results.size() == 4);
+    CHECK(results[0]);
+    CHECK_FALSE(results[1]);
+    CHECK(results[1].error.find("cannot open") != std::string::npos);
+    CHECK_FALSE(results[2]);
+    CHECK(results[2].error.find("missing top-level 'properties'") != std::string::npos);
+    CHECK(results[2].collection.features.empty());
+    CHECK(results[3]);
+    CHECK_FALSE(results[3].collection.features.empty());
+
+    std::filesystem::remove(bad);
+}
+
+TEST_CASE("Batch - Directory pattern") {
+    auto results = vectkit::read_all(PROJECT_DIR "/misc", "field4*.geojson");
+    REQUIRE(results.size() == 3);
+    CHECK(results[0].path.filename() == "field4.geojson");
+    CHECK(results[1].path.filename() == "field4_enu.geojson");
+    CHECK(results[2].path.filename() == "field4_modified.geojson");
+    for (const auto &r : results)
+        CHECK(r.ok());
+
+    CHECK(vectkit::ListFiles(PROJECT_DIR "/misc", "*.g?ojson").size() == 4);
+    CHECK(vectkit::ListFiles(PROJECT_DIR "/misc", "*.txt").empty());
+    CHECK_THROWS_WITH(vectkit::ListFiles("/nonexistent"), doctest::Contains("vectkit::ListFiles(): cannot list"));
+}
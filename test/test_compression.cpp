@@ -0,0 +1,140 @@
+#include <doctest/doctest.h>
+
+#include "vectkit/vectkit.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    void write_bytes(const std::filesystem::path &path, const std::string &content) {
+        std::ofstream ofs(path, std::ios::binary);
+        ofs << content;
+    }
+
+    size_t stream_count(const std::filesystem::path &path, size_t chunk_size) {
+        vectkit::FeatureReader reader(path, chunk_size);
+        size_t n = 0;
+        for (auto &f : reader) {
+            (void)f;
+            ++n;
+        }
+        return n;
+    }
+
+#if defined(VECTKIT_HAS_ZLIB) || defined(VECTKIT_HAS_ZSTD)
+    std::string read_bytes(const std::filesystem::path &path) {
+        std::ifstream ifs(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+    }
+
+    // Writes the reference file through the given extension and checks every reader gets it back
+    void check_round_trip(const std::string &ext, std::string_view magic) {
+        auto fc = vectkit::ReadFeatureCollection(PROJECT_DIR "/misc/wur.geojson");
+        const std::filesystem::path plain = "/tmp/test_compression_plain.geojson";
+        const std::filesystem::path packed = "/tmp/test_compression.geojson" + ext;
+        vectkit::write(fc, plain);
+        vectkit::write(fc, packed);
+
+        auto bytes = read_bytes(packed);
+        REQUIRE(bytes.size() > magic.size());
+        CHECK(std::string_view(bytes).substr(0, magic.size()) == magic);
+        CHECK(bytes.size() < std::filesystem::file_size(plain));
+
+        auto back = vectkit::read(packed);
+        CHECK(vectkit::write_to_string(back) == vectkit::write_to_string(vectkit::read(plain)));
+
+        vectkit::ReadOptions lazy;
+        lazy.lazy_properties = true;
+        CHECK(vectkit::write_to_string(vectkit::read(packed, lazy)) == vectkit::write_to_string(back));
+
+        // Detection goes by content, not by name
+        const std::filesystem::path renamed = "/tmp/test_compression_renamed.geojson";
+        write_bytes(renamed, bytes);
+        CHECK(vectkit::read(renamed).features.size() == back.features.size());
+
+        // Streaming decompresses a chunk at a time; a tiny window forces many refills
+        CHECK(stream_count(packed, 256) == back.features.size());
+
+        // A cut-off file is reported, not silently read short
+        write_bytes(renamed, bytes.substr(0, bytes.size() / 2));
+        CHECK_THROWS_WITH(vectkit::read(renamed), doctest::Contains("truncated"));
+        CHECK_THROWS_WITH(stream_count(renamed, 256), doctest::Contains("truncated"));
+
+        std::filesystem::remove(plain);
+        std::filesystem::remove(packed);
+        std::filesystem::remove(renamed);
+    }
+#endif
+} // namespace
+
+TEST_CASE("Compression - Detection") {
+    using vectkit::Compression;
+    CHECK(vectkit::detail::sniff_compression("\x1f\x8b\x08") == Compression::Gzip);
+    CHECK(vectkit::detail::sniff_compression(std::string_view("\x28\xb5\x2f\xfd\x00", 5)) == Compression::Zstd);
+    CHECK(vectkit::detail::sniff_compression("{\"type\"") == Compression::None);
+    CHECK(vectkit::detail::sniff_compression("") == Compression::None);
+
+    CHECK(vectkit::detail::compression_for("a/b.geojson.gz") == Compression::Gzip);
+    CHECK(vectkit::detail::compression_for("a/b.geojson.ZST") == Compression::Zstd);
+    CHECK(vectkit::detail::compression_for("a/b.geojson") == Compression::None);
+}
+
+TEST_CASE("Compression - Uncompressed input is passed through") {
+    // Shorter than any magic number
+    const std::filesystem::path test_file = "/tmp/test_compression_short.geojson";
+    write_bytes(test_file, "{}");
+    CHECK_THROWS_WITH(vectkit::FeatureReader{test_file},
+                      "vectkit::FeatureReader(): top-level object has no string 'type' field");
+    std::filesystem::remove(test_file);
+
+    CHECK(stream_count(PROJECT_DIR "/misc/wur.geojson", 256) ==
+          vectkit::ReadFeatureCollection(PROJECT_DIR "/misc/wur.geojson").features.size());
+}
+
+#ifdef VECTKIT_HAS_ZLIB
+TEST_CASE("Compression - gzip") {
+    check_round_trip(".gz", "\x1f\x8b");
+
+    SUBCASE("Concatenated members") {
+        auto fc = vectkit::ReadFeatureCollection(PROJECT_DIR "/misc/wur.geojson");
+        auto text = vectkit::write_to_string(fc);
+        const std::filesystem::path a = "/tmp/test_compression_a.gz";
+        const std::filesystem::path b = "/tmp/test_compression_b.gz";
+
+        // Same document, split across two gzip members as `cat a.gz b.gz` would produce
+        {
+            std::ofstream ofs(a, std::ios::binary);
+            vectkit::detail::StreamSink sink(ofs);
+            vectkit::detail::CompressedOutput out(sink, vectkit::Compression::Gzip, "test");
+            out.write(std::string_view(text).substr(0, text.size() / 2));
+            out.finish();
+        }
+        {
+            std::ofstream ofs(b, std::ios::binary);
+            vectkit::detail::StreamSink sink(ofs);
+            vectkit::detail::CompressedOutput out(sink, vectkit::Compression::Gzip, "test");
+            out.write(std::string_view(text).substr(text.size() / 2));
+            out.finish();
+        }
+        const std::filesystem::path joined = "/tmp/test_compression_joined.geojson.gz";
+        write_bytes(joined, read_bytes(a) + read_bytes(b));
+        CHECK(vectkit::read(joined).features.size() == fc.features.size());
+        CHECK(stream_count(joined, 256) == fc.features.size());
+
+        std::filesystem::remove(a);
+        std::filesystem::remove(b);
+        std::filesystem::remove(joined);
+    }
+}
+#else
+TEST_CASE("Compression - gzip unavailable") {
+    auto fc = vectkit::ReadFeatureCollection(PROJECT_DIR "/misc/wur.geojson");
+    CHECK_THROWS_WITH(vectkit::write(fc, "/tmp/test_compression.geojson.gz"),
+                      doctest::Contains("gzip support was not compiled in"));
+    CHECK_FALSE(std::filesystem::exists("/tmp/test_compression.geojson.gz"));
+}
+#endif
+
+#ifdef VECTKIT_HAS_ZSTD
+TEST_CASE("Compression - zstd") { check_round_trip(".zst", std::string_view("\x28\xb5\x2f\xfd", 4)); }
+#endif
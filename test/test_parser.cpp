@@ -3,6 +3,7 @@
 #include "vectkit/vectkit.hpp"
 #include <filesystem>
 #include <fstream>
+#include <string>
 
 namespace dp = ::datapod;
 
@@ -206,4 +207,676 @@ TEST_CASE("Parser - File operations") {
 
         std::filesystem::remove(test_file);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Parser - Number literals are read exactly") {
+    const std::string test_content = R"({
+        "type": "FeatureCollection",
+        "properties": {"crs": "ENU", "datum": [5.662320979285482, 51.98604250656666, -0.0], "heading": 1E-3},
+        "features": [
+            {"type": "Feature", "geometry": {"type": "Point", "coordinates": [1e2, -2.5E-1, 0.1]}, "properties": {}}
+        ]
+    })";
+
+    const std::filesystem::path test_file = "/tmp/test_numbers.geojson";
+    std::ofstream ofs(test_file);
+    ofs << test_content;
+    ofs.close();
+
+    auto fc = vectkit::ReadFeatureCollection(test_file);
+    CHECK(fc.datum.longitude == 5.662320979285482);
+    CHECK(fc.datum.latitude == 51.98604250656666);
+    CHECK(fc.heading.yaw == 0.001);
+
+    auto &p = std::get<dp::Point>(fc.features[0].geometry);
+    CHECK(p.x == 100.0);
+    CHECK(p.y == -0.25);
+    CHECK(p.z == 0.1);
+
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Parser - Geometry members in any order") {
+    // Features come before the header, "coordinates" before "type" and "properties" before "geometry"
+    const std::string test_content = R"({
+        "features": [
+            {"properties": {"name": "ring", "tags": { "a" : [1, 2] }, "quote": "say \"hi\" \u00e9"},
+             "geometry": {"coordinates": [[[0, 0], [4, 0], [4, 4]], [[1, 1], [2, 1], [2, 2]]], "type": "Polygon"},
+             "type": "Feature"},
+            {"type": "Feature", "geometry": null, "properties": {}},
+            {"type": "Feature", "properties": {"kind": "multi"},
+             "geometry": {"type": "GeometryCollection", "geometries": [
+                 {"coordinates": [[0, 0], [1, 1]], "type": "LineString"},
+                 {"type": "MultiPoint", "coordinates": [[5, 6], [7, 8, 9]]}
+             ]}}
+        ],
+        "type": "FeatureCollection",
+        "properties": {"crs": "ENU", "datum": [5.0, 52.0, 0.0], "heading": 0.0}
+    })";
+
+    const std::filesystem::path test_file = "/tmp/test_member_order.geojson";
+    std::ofstream ofs(test_file);
+    ofs << test_content;
+    ofs.close();
+
+    auto fc = vectkit::ReadFeatureCollection(test_file);
+    REQUIRE(fc.features.size() == 4);
+
+    auto &ring = std::get<dp::Polygon>(fc.features[0].geometry);
+    REQUIRE(ring.vertices.size() == 3); // only the outer ring is kept
+    CHECK(ring.vertices[1].x == 4.0);
+    CHECK(fc.features[0].properties.at("tags") == R"({"a":[1,2]})");
+    CHECK(fc.features[0].properties.at("quote") == "say \"hi\" \u00e9");
+
+    auto &seg = std::get<dp::Segment>(fc.features[1].geometry);
+    CHECK(seg.end.y == 1.0);
+    CHECK(std::get<dp::Point>(fc.features[2].geometry).x == 5.0);
+    auto &p = std::get<dp::Point>(fc.features[3].geometry);
+    CHECK(p.z == 9.0);
+    for (size_t i = 1; i < 4; ++i)
+        CHECK(fc.features[i].properties.at("kind") == "multi");
+
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Parser - Malformed feature text throws") {
+    const std::string header =
+        R"({"type": "FeatureCollection", "properties": {"crs": "ENU", "datum": [0, 0, 0], "heading": 0}, )";
+    const std::filesystem::path test_file = "/tmp/test_malformed_feature.geojson";
+
+    for (const char *features : {R"("features": [{"geometry": {"type": "Point", "coordinates": [1, 2}}]})",
+                                 R"("features": [{"geometry": {"type": "Point", "coordinates": [1 2]}}]})",
+                                 R"("features": [{"geometry" {"type": "Point"}}]})", R"("features": [})"}) {
+        std::ofstream ofs(test_file);
+        ofs << header << features;
+        ofs.close();
+        CHECK_THROWS_WITH(vectkit::ReadFeatureCollection(test_file),
+                          doctest::Contains("vectkit::ReadFeatureCollection(): failed to parse JSON"));
+    }
+
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Parser - Threaded read matches serial read") {
+    // About 1 MiB of features, with nested objects and strings that look like element boundaries
+    std::string content = R"({"type": "FeatureCollection",
+        "properties": {"crs": "EPSG:4326", "datum": [5.0, 52.0, 0.0], "heading": 0.0}, "features": [)";
+    for (int i = 0; i < 4000; ++i) {
+        if (i > 0)
+            content += ",\n";
+        double x = 5.0 + i * 1e-5;
+        std::string pt = "[" + std::to_string(x) + ", 52.0" + (i % 3 ? "" : ", 1.5") + "]";
+        switch (i % 4) {
+        case 0:
+            content += R"({"type": "Feature", "geometry": {"type": "Point", "coordinates": )" + pt + "}, ";
+            break;
+        case 1:
+            content += R"({"type": "Feature", "geometry": {"type": "GeometryCollection", "geometries": [)"
+                       R"({"type": "Point", "coordinates": )" +
+                       pt + R"(}, {"type": "LineString", "coordinates": [)" + pt + ", " + pt + ", " + pt +
+                       "]}]}, ";
+            break;
+        case 2:
+            content += R"({"type": "Feature", "geometry": {"coordinates": [[)" + pt + ", " + pt + ", " + pt +
+                       R"(]], "type": "Polygon"}, )";
+            break;
+        default:
+            content += R"({"type": "Feature", "geometry": null, )";
+            break;
+        }
+        content += R"("properties": {"id": )" + std::to_string(i) +
+                   R"(, "tricky": "a,{", "list": [{"k": 1}, {"k": 2}], "pad": ")" + std::string(150, 'x') + "\"}}";
+    }
+    content += R"(], "name": "after"})";
+
+    const std::filesystem::path test_file = "/tmp/test_threaded.geojson";
+    std::ofstream ofs(test_file);
+    ofs << content;
+    ofs.close();
+
+    auto serial = vectkit::ReadFeatureCollection(test_file);
+    auto threaded = vectkit::ReadFeatureCollection(test_file, {.threads = 4});
+
+    REQUIRE(serial.features.size() == 4000);
+    REQUIRE(threaded.features.size() == serial.features.size());
+    CHECK(threaded.global_properties == serial.global_properties);
+    for (size_t i = 0; i < serial.features.size(); ++i) {
+        const auto &a = serial.features[i];
+        const auto &b = threaded.features[i];
+        REQUIRE(a.geometry.index() == b.geometry.index());
+        CHECK(a.properties == b.properties);
+        if (auto *p = std::get_if<dp::Point>(&a.geometry)) {
+            CHECK(p->x == std::get<dp::Point>(b.geometry).x);
+            CHECK(p->z == std::get<dp::Point>(b.geometry).z);
+        } else if (auto *poly = std::get_if<dp::Polygon>(&a.geometry)) {
+            CHECK(poly->vertices.size() == std::get<dp::Polygon>(b.geometry).vertices.size());
+        }
+    }
+
+    // The first error in file order wins, as in a serial read
+    auto bad = content;
+    bad.replace(bad.find("[5.025000, 52.0]"), 16, "[5.025000]");
+    bad.replace(bad.rfind("\"tricky\""), 1, "{");
+    std::ofstream bad_ofs(test_file);
+    bad_ofs << bad;
+    bad_ofs.close();
+    CHECK_THROWS_WITH(vectkit::ReadFeatureCollection(test_file, {.threads = 4}), "Invalid point coordinates");
+
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Parser - Top-level Feature and bare geometry") {
+    const std::string header = R"("crs": "EPSG:4326", "datum": [5.0, 52.0, 10.0], "heading": 1.5)";
+    const std::string path = R"([[5.001, 52.001], [5.002, 52.002, 12.0], [5.003, 52.003]])";
+    const std::filesystem::path test_file = "/tmp/test_single.geojson";
+    auto read = [&](const std::string &content) {
+        std::ofstream ofs(test_file);
+        ofs << content;
+        ofs.close();
+        return vectkit::ReadFeatureCollection(test_file);
+    };
+
+    // Reference: the same path inside a regular collection
+    auto expected = read(R"({"type": "FeatureCollection", "properties": {)" + header +
+                         R"(}, "features": [{"type": "Feature", "geometry": {"type": "LineString", "coordinates": )" +
+                         path + "}}]}");
+    auto &expected_path = std::get<std::vector<dp::Point>>(expected.features[0].geometry);
+
+    SUBCASE("Feature with its header after the geometry") {
+        auto fc = read(R"({"type": "Feature", "geometry": {"coordinates": )" + path +
+                       R"(, "type": "LineString"}, "properties": {"name": "survey", )" + header + "}}");
+        CHECK(fc.datum.latitude == 52.0);
+        CHECK(fc.heading.yaw == 1.5);
+        CHECK(fc.global_properties.empty());
+        REQUIRE(fc.features.size() == 1);
+        CHECK(fc.features[0].properties.size() == 1);
+        CHECK(fc.features[0].properties.at("name") == "survey");
+
+        auto &pts = std::get<std::vector<dp::Point>>(fc.features[0].geometry);
+        REQUIRE(pts.size() == 3);
+        for (size_t i = 0; i < 3; ++i) {
+            CHECK(pts[i].x == doctest::Approx(expected_path[i].x));
+            CHECK(pts[i].y == doctest::Approx(expected_path[i].y));
+            CHECK(pts[i].z == doctest::Approx(expected_path[i].z));
+        }
+    }
+
+    SUBCASE("Bare geometries") {
+        auto line = read(R"({"coordinates": )" + path + R"(, "type": "LineString", "properties": {)" + header + "}}");
+        REQUIRE(line.features.size() == 1);
+        CHECK(std::get<std::vector<dp::Point>>(line.features[0].geometry)[1].z == doctest::Approx(expected_path[1].z));
+
+        auto multi = read(R"({"type": "GeometryCollection", "properties": {)" + header +
+                          R"(}, "geometries": [{"type": "Point", "coordinates": [5.0, 52.0]},)"
+                          R"({"type": "MultiPoint", "coordinates": [[5.0, 52.0, 10.0], [5.0, 52.0]]}]})");
+        REQUIRE(multi.features.size() == 3);
+        for (const auto &f : multi.features) {
+            auto &p = std::get<dp::Point>(f.geometry);
+            CHECK(p.x == doctest::Approx(0.0));
+            CHECK(p.y == doctest::Approx(0.0));
+        }
+    }
+
+    SUBCASE("Header is still required") {
+        CHECK_THROWS_WITH(read(R"({"type": "Point", "coordinates": [1, 2]})"), "missing top-level 'properties'");
+        CHECK_THROWS_WITH(read(R"({"type": "Feature", "geometry": null, "properties": {"crs": "ENU"}})"),
+                          "'properties' missing array 'datum' of ≥3 numbers");
+    }
+
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Parser - ParseContext reuse") {
+    const std::string header =
+        R"({"type": "FeatureCollection", "properties": {"crs": "EPSG:4326", "datum": [5.0, 52.0, 0.0], "heading": 0.0)";
+    auto collection = [&](int n, const std::string &tag) {
+        std::string text = header + R"(, "tag": ")" + tag + R"("}, "features": [)";
+        for (int i = 0; i < n; ++i) {
+            if (i)
+                text += ',';
+            text += R"({"type": "Feature", "geometry": {"type": "LineString", "coordinates": [[5.0, 52.0], [5.001, )" +
+                    std::to_string(52.0 + i * 1e-4) + R"(], [5.002, 52.0]]}, "properties": {"i": )" +
+                    std::to_string(i) + "}}";
+        }
+        return text + "]}";
+    };
+
+    auto check_same = [](const vectkit::FeatureCollection &a, const vectkit::FeatureCollection &b) {
+        CHECK(a.global_properties == b.global_properties);
+        REQUIRE(a.features.size() == b.features.size());
+        for (size_t i = 0; i < a.features.size(); ++i) {
+            CHECK(a.features[i].properties == b.features[i].properties);
+            auto &pa = std::get<std::vector<dp::Point>>(a.features[i].geometry);
+            auto &pb = std::get<std::vector<dp::Point>>(b.features[i].geometry);
+            REQUIRE(pa.size() == pb.size());
+            for (size_t k = 0; k < pa.size(); ++k) {
+                CHECK(pa[k].x == pb[k].x);
+                CHECK(pa[k].y == pb[k].y);
+            }
+        }
+    };
+
+    vectkit::ParseContext ctx;
+    const std::filesystem::path test_file = "/tmp/test_context.geojson";
+
+    // Growing, shrinking and growing again must not leak anything from one read into the next
+    for (int n : {50, 3, 200, 0, 20}) {
+        auto text = collection(n, "run" + std::to_string(n));
+        check_same(ctx.read_from_buffer(text), vectkit::read_from_buffer(text));
+
+        std::ofstream ofs(test_file);
+        ofs << text;
+        ofs.close();
+        check_same(ctx.read(test_file), vectkit::ReadFeatureCollection(test_file));
+    }
+
+    SUBCASE("A small read after a large one does not keep the large capacity") {
+        ctx.read_from_buffer(collection(5000, "large"));
+        auto small = ctx.read_from_buffer(collection(1, "small"));
+        CHECK(small.features.size() == 1);
+        CHECK(small.features.capacity() < 50);
+    }
+
+    SUBCASE("A failed read leaves the context usable") {
+        CHECK_THROWS_WITH(ctx.read_from_buffer(R"({"type": "FeatureCollection", "features": []})"),
+                          "missing top-level 'properties'");
+        CHECK_THROWS(ctx.read_from_buffer(collection(10, "x").substr(0, 300)));
+        CHECK_THROWS_WITH(ctx.read("/tmp/does_not_exist.geojson"), doctest::Contains("cannot open"));
+
+        auto text = collection(10, "after");
+        check_same(ctx.read_from_buffer(text), vectkit::read_from_buffer(text));
+    }
+
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Parser - read_into reuses the collection's storage") {
+    const std::filesystem::path test_file = "/tmp/test_read_into.geojson";
+    auto write = [&](const std::string &globals, const std::string &features) {
+        std::ofstream ofs(test_file);
+        ofs << R"({"type": "FeatureCollection", "properties": {"crs": "EPSG:4326", "datum": [5.0, 52.0, 0.0],)"
+            << R"( "heading": 0.0)" << globals << R"(}, "features": [)" << features << "]}";
+    };
+    const std::string path_feature =
+        R"({"type": "Feature", "geometry": {"type": "LineString", "coordinates": [[5.0, 52.0], [5.001, 52.0],)"
+        R"( [5.002, 52.001]]}, "properties": {"name": "path", "width": 2}})";
+    const std::string polygon_feature =
+        R"({"type": "Feature", "geometry": {"type": "Polygon", "coordinates": [[[5.0, 52.0], [5.001, 52.0],)"
+        R"( [5.001, 52.001], [5.0, 52.0]]]}, "properties": {"name": "field"}})";
+
+    vectkit::ParseContext ctx;
+    vectkit::FeatureCollection fc;
+    write(R"(, "owner": "a", "stale": 1)", path_feature + "," + polygon_feature);
+    ctx.read_into(test_file, fc);
+    REQUIRE(fc.features.size() == 2);
+    const auto *path_data = std::get<std::vector<dp::Point>>(fc.features[0].geometry).data();
+    const auto *features_data = fc.features.data();
+
+    SUBCASE("Same shapes are rebuilt in place") {
+        for (int i = 0; i < 3; ++i) {
+            ctx.read_into(test_file, fc);
+            REQUIRE(fc.features.size() == 2);
+            CHECK(fc.features.data() == features_data);
+            CHECK(std::get<std::vector<dp::Point>>(fc.features[0].geometry).data() == path_data);
+            CHECK(fc.features[0].properties.at("width") == "2");
+            CHECK(std::get<dp::Polygon>(fc.features[1].geometry).vertices.size() == 4);
+        }
+    }
+
+    SUBCASE("Different contents replace the old ones completely") {
+        write(R"(, "owner": "b")", polygon_feature + "," + polygon_feature + "," + path_feature);
+        vectkit::read_into(test_file, fc);
+        auto expected = vectkit::ReadFeatureCollection(test_file);
+        CHECK(fc.global_properties == expected.global_properties);
+        CHECK(fc.global_properties.count("stale") == 0);
+        REQUIRE(fc.features.size() == 3);
+        for (size_t i = 0; i < 3; ++i)
+            CHECK(fc.features[i].properties == expected.features[i].properties);
+        CHECK(std::holds_alternative<dp::Polygon>(fc.features[0].geometry));
+        CHECK(std::get<std::vector<dp::Point>>(fc.features[2].geometry).size() == 3);
+
+        write("", "");
+        ctx.read_into(test_file, fc);
+        CHECK(fc.features.empty());
+        CHECK(fc.global_properties.empty());
+    }
+
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Parser - Tokens across scan block boundaries") {
+    // The scanner classifies the input 32 bytes at a time; put every kind of token at every offset
+    // around a block edge
+    auto document = [](const std::string &ws, const std::string &value, const std::string &number) {
+        return "{" + ws + R"("type":)" + ws + R"("FeatureCollection",)" + ws +
+               R"("properties": {"crs": "EPSG:4326", "datum": [5.0, 52.0, 0.0], "heading": 0.0},)" + ws +
+               R"("features": [{"type": "Feature", "properties": {"v": ")" + value + R"("}, "geometry":)" + ws +
+               R"({"type": "Point", "coordinates": [)" + number + "," + ws + "52.0]}}]" + ws + "}" + ws;
+    };
+
+    for (size_t k = 0; k < 70; ++k) {
+        std::string ws;
+        for (size_t i = 0; i < k; ++i)
+            ws += " \n\t\r"[i % 4];
+        std::string value = std::string(k, 'a') + R"(\")" + std::string(40, 'b') + R"(\\)" + std::string(k % 7, 'c');
+        std::string number = "5" + std::string(k, '0') + "e-" + std::to_string(k);
+
+        auto fc = vectkit::read_from_buffer(document(ws, value, number));
+        REQUIRE(fc.features.size() == 1);
+        CHECK(fc.features[0].properties.at("v") ==
+              std::string(k, 'a') + '"' + std::string(40, 'b') + '\\' + std::string(k % 7, 'c'));
+        CHECK(std::get<dp::Point>(fc.features[0].geometry).x == doctest::Approx(0.0).epsilon(1e-6));
+
+        std::string control = std::string(k, 'a') + '\x01' + std::string(40, 'b');
+        CHECK_THROWS_WITH(vectkit::read_from_buffer(document(ws, control, number)),
+                          doctest::Contains("control character in string"));
+
+        auto unterminated = document(ws, value, number);
+        unterminated.resize(unterminated.find(R"("v": ")") + 6 + k + 20);
+        CHECK_THROWS_WITH(vectkit::read_from_buffer(unterminated), doctest::Contains("failed to parse JSON"));
+    }
+}
+
+TEST_CASE("Parser - Property projection and filters") {
+    // A multi-layer file: obstacles as polygons, a path as a line, markers as points. The obstacle
+    // with an invalid point is only ever rejected, so reading it would throw.
+    const std::string text = R"({"type": "FeatureCollection", "properties": {"crs": "EPSG:4326",
+        "datum": [5.0, 52.0, 0.0], "heading": 0.0, "site": "wur"}, "features": [
+        {"type": "Feature", "properties": {"type": "obstacle", "id": 1, "note": "barn"},
+         "geometry": {"type": "Polygon", "coordinates": [[[5.0, 52.0], [5.001, 52.0], [5.0, 52.001], [5.0, 52.0]]]}},
+        {"type": "Feature", "geometry": {"type": "Point", "coordinates": [5.0]},
+         "properties": {"type": "broken", "id": 2}},
+        {"type": "Feature", "properties": {"type": "path", "id": 3},
+         "geometry": {"type": "LineString", "coordinates": [[5.0, 52.0], [5.001, 52.0], [5.002, 52.0]]}},
+        {"type": "Feature", "geometry": {"coordinates": [[5.0, 52.0], [5.001, 52.001]], "type": "MultiPoint"},
+         "properties": {"type": "marker", "id": 4}},
+        {"type": "Feature", "properties": {"type": "obstacle", "id": 5},
+         "geometry": {"type": "GeometryCollection", "geometries": [
+             {"type": "Point", "coordinates": [5.0, 52.0]},
+             {"type": "Polygon", "coordinates": [[[5.0, 52.0], [5.001, 52.0], [5.0, 52.001], [5.0, 52.0]]]}]}}
+    ]})";
+
+    CHECK_THROWS_WITH(vectkit::read_from_buffer(text), "Invalid point coordinates");
+
+    auto is_not_broken = [](const vectkit::Properties::Map &p) {
+        auto it = p.find("type");
+        return it == p.end() || it->second != "broken";
+    };
+
+    SUBCASE("Predicate runs before the geometry is decoded") {
+        vectkit::ReadOptions options;
+        options.filter = is_not_broken;
+        auto fc = vectkit::read_from_buffer(text, options);
+        REQUIRE(fc.features.size() == 6);
+        CHECK(fc.features[0].properties.at("note") == "barn");
+        CHECK(fc.global_properties.at("site") == "wur");
+
+        options.filter = [](const auto &p) { return p.at("type") == "obstacle"; };
+        fc = vectkit::read_from_buffer(text, options);
+        REQUIRE(fc.features.size() == 3);
+        CHECK(std::holds_alternative<dp::Polygon>(fc.features[0].geometry));
+        CHECK(std::holds_alternative<dp::Point>(fc.features[1].geometry));
+        CHECK(fc.features[2].properties.at("id") == "5");
+    }
+
+    SUBCASE("Projection keeps only the listed keys") {
+        vectkit::ReadOptions options;
+        options.filter = is_not_broken;
+        options.properties = std::vector<std::string>{"id", "missing"};
+        auto fc = vectkit::read_from_buffer(text, options);
+        REQUIRE(fc.features.size() == 6);
+        for (const auto &f : fc.features) {
+            CHECK(f.properties.size() == 1);
+            CHECK(f.properties.count("id") == 1);
+        }
+        CHECK(fc.global_properties.size() == 1);
+
+        // The predicate still sees every key
+        options.filter = [](const auto &p) { return p.count("note") == 1; };
+        fc = vectkit::read_from_buffer(text, options);
+        REQUIRE(fc.features.size() == 1);
+        CHECK(fc.features[0].properties.count("note") == 0);
+
+        options.filter = {};
+        options.properties = std::vector<std::string>{};
+        options.geometry_types = {vectkit::GeometryType::Polygon};
+        fc = vectkit::read_from_buffer(text, options);
+        REQUIRE(fc.features.size() == 2);
+        CHECK(fc.features[0].properties.empty());
+    }
+
+    SUBCASE("Geometry type filter") {
+        vectkit::ReadOptions options;
+        options.geometry_types = {vectkit::GeometryType::LineString, vectkit::GeometryType::MultiPoint};
+        auto fc = vectkit::read_from_buffer(text, options);
+        REQUIRE(fc.features.size() == 3);
+        CHECK(std::holds_alternative<std::vector<dp::Point>>(fc.features[0].geometry));
+        CHECK(fc.features[1].properties.at("id") == "4");
+        CHECK(fc.features[2].properties.at("id") == "4");
+
+        // Multi-threaded and single-feature reads honour the same options
+        options.threads = 4;
+        CHECK(vectkit::read_from_buffer(text, options).features.size() == 3);
+
+        options.geometry_types = {vectkit::GeometryType::Point};
+        const std::string single = R"({"type": "Feature", "geometry": {"type": "LineString", "coordinates": [[5, 52],
+            [6, 52]]}, "properties": {"crs": "EPSG:4326", "datum": [5.0, 52.0, 0.0], "heading": 0.0}})";
+        CHECK(vectkit::read_from_buffer(single, options).features.empty());
+        options.geometry_types = {};
+        options.filter = [](const auto &p) { return p.empty(); };
+        CHECK(vectkit::read_from_buffer(single, options).features.size() == 1);
+    }
+}
+
+TEST_CASE("Parser - Region filter") {
+    // A 20 x 20 grid of points 0.001° apart, plus shapes that cross or surround the region without
+    // having a vertex in it
+    std::string text = R"({"type": "FeatureCollection", "properties": {"crs": "EPSG:4326",
+        "datum": [5.0, 52.0, 0.0], "heading": 0.0}, "features": [)";
+    for (int i = 0; i < 20; ++i) {
+        for (int j = 0; j < 20; ++j) {
+            text += R"({"type": "Feature", "properties": {"name": "p"}, "geometry": {"type": "Point",)"
+                    R"( "coordinates": [)" +
+                    std::to_string(5.0 + i * 0.001) + ", " + std::to_string(52.0 + j * 0.001) + "]}},";
+        }
+    }
+    text += R"({"type": "Feature", "properties": {"name": "crossing"}, "geometry": {"type": "LineString",
+                "coordinates": [[5.004, 52.0], [5.006, 52.02], [5.008, 52.0]]}},
+               {"type": "Feature", "properties": {"name": "around"}, "geometry": {"type": "Polygon",
+                "coordinates": [[[4.9, 51.9], [5.1, 51.9], [5.1, 52.1], [4.9, 52.1], [4.9, 51.9]]]}},
+               {"type": "Feature", "properties": {"name": "far"}, "geometry": {"type": "LineString",
+                "coordinates": [[6.0, 53.0], [6.1, 53.1], [6.2, 53.0]]}},
+               {"type": "Feature", "properties": {"name": "parts"}, "geometry": {"type": "MultiPoint",
+                "coordinates": [[5.007, 52.007], [5.015, 52.015]]}}]})";
+
+    auto count = [](const vectkit::FeatureCollection &fc, const std::string &name) {
+        return std::count_if(fc.features.begin(), fc.features.end(),
+                             [&](const auto &f) { return f.properties.at("name") == name; });
+    };
+
+    vectkit::ReadOptions options;
+    options.region = vectkit::Region::box(vectkit::CRS::WGS, 5.0045, 52.0045, 5.0095, 52.0095);
+    auto wgs = vectkit::read_from_buffer(text, options);
+    CHECK(count(wgs, "p") == 25);
+    CHECK(count(wgs, "crossing") == 1);
+    CHECK(count(wgs, "around") == 1);
+    CHECK(count(wgs, "far") == 0);
+    CHECK(count(wgs, "parts") == 1);
+
+    // Points keep their full conversion
+    auto full = vectkit::read_from_buffer(text);
+    auto &first = std::get<dp::Point>(wgs.features[0].geometry);
+    auto &reference = std::get<dp::Point>(full.features[5 * 20 + 5].geometry);
+    CHECK(first.x == reference.x);
+    CHECK(first.y == reference.y);
+
+    SUBCASE("The same box given in ENU") {
+        auto &lo = std::get<dp::Point>(full.features[5 * 20 + 5].geometry);  // (5.005, 52.005)
+        auto &hi = std::get<dp::Point>(full.features[9 * 20 + 9].geometry);  // (5.009, 52.009)
+        double half_x = (hi.x - lo.x) / 8, half_y = (hi.y - lo.y) / 8; // half a grid step
+        options.region = vectkit::Region::box(vectkit::CRS::ENU, lo.x - half_x, lo.y - half_y, hi.x + half_x,
+                                              hi.y + half_y);
+        auto enu = vectkit::read_from_buffer(text, options);
+        CHECK(count(enu, "p") == 25);
+        CHECK(count(enu, "crossing") == 1);
+        CHECK(count(enu, "around") == 1);
+        CHECK(count(enu, "far") == 0);
+    }
+
+    SUBCASE("Clip polygon") {
+        // Triangle over the lower-left corner of the grid, its long side half a step past i + j = 10
+        options.region = vectkit::Region{vectkit::CRS::WGS, {dp::Point{4.9995, 51.9995, 0.0},
+                                                             dp::Point{5.011, 51.9995, 0.0},
+                                                             dp::Point{4.9995, 52.011, 0.0}}};
+        auto tri = vectkit::read_from_buffer(text, options);
+        CHECK(count(tri, "p") == 11 * 12 / 2); // i + j <= 10
+        CHECK(count(tri, "around") == 1);
+        CHECK(count(tri, "parts") == 0);
+    }
+
+    SUBCASE("Single feature documents") {
+        const std::string single = R"({"type": "MultiPoint", "coordinates": [[5.0, 52.0], [7.0, 52.0]],
+            "properties": {"crs": "EPSG:4326", "datum": [5.0, 52.0, 0.0], "heading": 0.0}})";
+        options.region = vectkit::Region::box(vectkit::CRS::ENU, -10.0, -10.0, 10.0, 10.0);
+        auto fc = vectkit::read_from_buffer(single, options);
+        REQUIRE(fc.features.size() == 1);
+        CHECK(std::get<dp::Point>(fc.features[0].geometry).x == doctest::Approx(0.0));
+    }
+}
+
+TEST_CASE("Parser - Multi* parts share one property set") {
+    std::string multi = R"({"type": "FeatureCollection", "properties": {"crs": "EPSG:4326",
+        "datum": [5.0, 52.0, 0.0], "heading": 0.0}, "features": [{"type": "Feature",
+        "properties": {"kind": "samples"}, "geometry": {"type": "MultiPoint", "coordinates": [)";
+    for (int i = 0; i < 1000; ++i)
+        multi += (i ? ", [" : "[") + std::to_string(5.0 + i * 1e-5) + ", 52.0]";
+    multi += "]}}]}";
+    auto fc = vectkit::read_from_buffer(multi);
+    REQUIRE(fc.features.size() == 1000);
+    for (const auto &f : fc.features)
+        CHECK(f.properties.shares(fc.features[0].properties));
+
+    fc.features[3].properties["kind"] = "outlier";
+    CHECK(fc.features[0].properties.at("kind") == "samples");
+    CHECK(fc.features[4].properties.at("kind") == "samples");
+}
+
+TEST_CASE("Parser - Multi-part geometries kept whole") {
+    const std::string json = R"({"type": "FeatureCollection", "properties": {"crs": "ENU",
+        "datum": [5.0, 52.0, 0.0], "heading": 0.0}, "features": [
+        {"type": "Feature", "properties": {"id": "1"}, "geometry": {"type": "MultiPolygon", "coordinates": [
+            [[[0, 0], [10, 0], [10, 10], [0, 0]], [[2, 1], [3, 1], [3, 2], [2, 1]]],
+            [[[20, 0], [30, 0], [30, 10], [20, 0]]]]}},
+        {"type": "Feature", "properties": {"id": "2"}, "geometry": {"type": "Polygon", "coordinates": [
+            [[0, 0], [10, 0], [10, 10], [0, 0]], [[2, 1], [3, 1], [3, 2], [2, 1]]]}},
+        {"type": "Feature", "properties": {"id": "3"}, "geometry": {"type": "MultiLineString", "coordinates": [
+            [[0, 0], [1, 1]], [[2, 2], [3, 3], [4, 4]]]}},
+        {"type": "Feature", "properties": {"id": "4"}, "geometry": {"type": "MultiPoint", "coordinates": [
+            [0, 0], [1, 1, 5]]}},
+        {"type": "Feature", "properties": {"id": "5"}, "geometry": {"type": "Polygon", "coordinates": [
+            [[0, 0], [1, 0], [1, 1], [0, 0]]]}}]})";
+
+    SUBCASE("Split by default") {
+        auto fc = vectkit::read_from_buffer(json);
+        CHECK(fc.features.size() == 8);
+        CHECK(std::holds_alternative<dp::Polygon>(fc.features[2].geometry));
+        CHECK(std::get<dp::Polygon>(fc.features[2].geometry).vertices.size() == 4);
+    }
+
+    auto fc = vectkit::read_from_buffer(json, vectkit::ReadOptions{.keep_multipart = true});
+    REQUIRE(fc.features.size() == 5);
+
+    SUBCASE("Flat buffers with offsets") {
+        auto &mp = std::get<vectkit::MultiPolygon>(fc.features[0].geometry);
+        CHECK(mp.points.size() == 12);
+        CHECK(mp.rings == std::vector<std::uint32_t>{4, 8, 12});
+        CHECK(mp.polygons == std::vector<std::uint32_t>{2, 3});
+        CHECK(mp.size() == 2);
+        CHECK(mp.polygon(1) == std::pair<size_t, size_t>{2, 3});
+        CHECK(mp.ring(1)[0].x == doctest::Approx(2.0));
+
+        auto &holed = std::get<vectkit::PolygonWithHoles>(fc.features[1].geometry);
+        CHECK(holed.size() == 2);
+        CHECK(holed.ring(1).size() == 4);
+
+        auto &lines = std::get<vectkit::MultiLineString>(fc.features[2].geometry);
+        CHECK(lines.size() == 2);
+        CHECK(lines.line(0).size() == 2);
+        CHECK(lines.line(1)[2].y == doctest::Approx(4.0));
+
+        auto &points = std::get<vectkit::MultiPoint>(fc.features[3].geometry);
+        REQUIRE(points.points.size() == 2);
+        CHECK(points.points[1].z == doctest::Approx(5.0));
+
+        // A polygon without holes stays a plain polygon
+        CHECK(std::holds_alternative<dp::Polygon>(fc.features[4].geometry));
+    }
+
+    SUBCASE("Written back as one feature each") {
+        std::string out;
+        vectkit::write_to_buffer(fc, out, vectkit::CRS::ENU);
+        CHECK(out.find(R"("type":"MultiPolygon")") != std::string::npos);
+        CHECK(out.find(R"("type":"MultiLineString")") != std::string::npos);
+
+        auto again = vectkit::read_from_buffer(out, vectkit::ReadOptions{.keep_multipart = true});
+        REQUIRE(again.features.size() == 5);
+        for (size_t i = 0; i < 4; ++i)
+            CHECK(vectkit::geometryToJson(again.features[i].geometry, again.datum, vectkit::CRS::ENU) ==
+                  vectkit::geometryToJson(fc.features[i].geometry, fc.datum, vectkit::CRS::ENU));
+    }
+
+    SUBCASE("Region tests the whole geometry") {
+        vectkit::ReadOptions options{.region = vectkit::Region::box(vectkit::CRS::ENU, 25, 1, 26, 2),
+                                     .keep_multipart = true};
+        auto hit = vectkit::read_from_buffer(json, options);
+        REQUIRE(hit.features.size() == 1);
+        CHECK(hit.features[0].properties.at("id") == "1");
+    }
+}
+
+TEST_CASE("Parser - Lazy properties") {
+    const std::filesystem::path file = "/tmp/vectkit_lazy.geojson";
+    {
+        std::ofstream out(file);
+        out << R"({"type": "FeatureCollection", "properties": {"crs": "ENU", "datum": [5.0, 52.0, 0.0],
+            "heading": 0.0}, "features": [
+            {"type": "Feature", "properties": {"name": "a\"b", "n": [1, 2], "o": {"k": true}},
+             "geometry": {"type": "MultiPoint", "coordinates": [[0, 0], [1, 1]]}},
+            {"type": "Feature", "properties": {}, "geometry": {"type": "Point", "coordinates": [2, 2]}},
+            {"type": "Feature", "properties": {"name": "x", "name": "y"},
+             "geometry": {"type": "Point", "coordinates": [3, 3]}}]})";
+    }
+    auto eager = vectkit::read(file);
+    auto fc = vectkit::read(file, vectkit::ReadOptions{.lazy_properties = true});
+    std::filesystem::remove(file); // the features keep the mapping
+
+    REQUIRE(fc.features.size() == eager.features.size());
+    CHECK_FALSE(fc.features[0].properties.decoded());
+    CHECK(fc.features[0].properties.shares(fc.features[1].properties));
+    CHECK(fc.features[2].properties.empty());
+    for (size_t i = 0; i < fc.features.size(); ++i)
+        CHECK(fc.features[i].properties == eager.features[i].properties);
+    CHECK(fc.features[1].properties.decoded());
+    CHECK(fc.features[0].properties.at("name") == "a\"b");
+    CHECK(fc.features[0].properties.at("o") == R"({"k":true})");
+    CHECK(fc.features[3].properties.at("name") == "y");
+
+    SUBCASE("Writes detach from the shared raw text") {
+        fc.features[0].properties["name"] = "c";
+        CHECK(fc.features[1].properties.at("name") == "a\"b");
+        CHECK(fc.features[0].properties.size() == 3);
+    }
+
+    SUBCASE("Buffers are copied, projections decode eagerly") {
+        std::string text = vectkit::toJson(eager, vectkit::CRS::ENU);
+        auto lazy = vectkit::read_from_buffer(text, vectkit::ReadOptions{.lazy_properties = true});
+        text.assign(text.size(), ' ');
+        CHECK(lazy.features[0].properties.at("n") == "[1,2]");
+
+        auto projected = vectkit::read_from_buffer(
+            vectkit::toJson(eager, vectkit::CRS::ENU),
+            vectkit::ReadOptions{.properties = std::vector<std::string>{"n"}, .lazy_properties = true});
+        CHECK(projected.features[0].properties.decoded());
+        CHECK(projected.features[0].properties.size() == 1);
+    }
+}
@@ -0,0 +1,188 @@
+#include <doctest/doctest.h>
+
+#include "vectkit/vectkit.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace dp = ::datapod;
+
+namespace {
+    std::string read_bytes(const std::filesystem::path &path) {
+        std::ifstream ifs(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+    }
+
+    void write_bytes(const std::filesystem::path &path, const std::string &content) {
+        std::ofstream ofs(path, std::ios::binary);
+        ofs << content;
+    }
+
+    // A log large enough to be cut into chunks, one point per line
+    std::string point_log(size_t count) {
+        std::string log = "\x1e" R"({"type": "FeatureCollection", "features": [],)"
+                          R"( "properties": {"crs": "EPSG:4326", "datum": [5.0, 52.0, 0.0], "heading": 0.0}})"
+                          "\n";
+        for (size_t i = 0; i < count; ++i) {
+            log += "\x1e";
+            log += R"({"type": "Feature", "geometry": {"type": "Point", "coordinates": [)" +
+                   std::to_string(5.0 + double(i) * 1e-6) + R"(, 52.0]}, "properties": {"id": )" +
+                   std::to_string(i) + R"(, "pad": ")" + std::string(100, 'x') + "\"}}\n";
+        }
+        return log;
+    }
+} // namespace
+
+TEST_CASE("Seq - Write and read back") {
+    auto fc = vectkit::ReadFeatureCollection(PROJECT_DIR "/misc/wur.geojson");
+    const std::filesystem::path test_file = "/tmp/test_seq.geojsons";
+
+    vectkit::write_seq(fc, test_file);
+    auto text = read_bytes(test_file);
+
+    // RS before and LF after every record: the header, then one per feature
+    CHECK(text.front() == '\x1e');
+    CHECK(text.back() == '\n');
+    CHECK(size_t(std::count(text.begin(), text.end(), '\x1e')) == fc.features.size() + 1);
+    CHECK(size_t(std::count(text.begin(), text.end(), '\n')) == fc.features.size() + 1);
+
+    auto back = vectkit::read_seq(test_file);
+    CHECK(back.datum.latitude == doctest::Approx(fc.datum.latitude));
+    CHECK(back.heading.yaw == doctest::Approx(fc.heading.yaw));
+    CHECK(back.global_properties == fc.global_properties);
+    // Same text as one write and read of the plain format
+    auto once = vectkit::read_from_buffer(vectkit::write_to_string(fc));
+    CHECK(vectkit::write_to_string(back) == vectkit::write_to_string(once));
+
+    // The header record alone is an ordinary (empty) FeatureCollection
+    auto header = vectkit::read_from_buffer(text.substr(1, text.find('\n')));
+    CHECK(header.features.empty());
+    CHECK(header.datum.latitude == doctest::Approx(fc.datum.latitude));
+
+    std::string buffer;
+    vectkit::write_seq_to_buffer(fc, buffer, vectkit::CRS::ENU);
+    auto enu = vectkit::read_seq_from_buffer(buffer);
+    vectkit::write_to_buffer(fc, buffer, vectkit::CRS::ENU);
+    CHECK(vectkit::write_to_string(enu) == vectkit::write_to_string(vectkit::read_from_buffer(buffer)));
+
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Seq - Newline-delimited records") {
+    // No record separators, CRLF line ends, blank lines, and the header carried by the first Feature
+    const std::string text =
+        R"({"type": "Feature", "geometry": {"type": "Point", "coordinates": [5.1, 52.1]},)"
+        R"( "properties": {"crs": "EPSG:4326", "datum": [5.0, 52.0, 0.0], "heading": 0.5, "id": 0}})"
+        "\r\n\r\n" R"({"type": "Feature", "geometry": {"type": "Point", "coordinates": [5.2, 52.2]}, "properties": {"id": 1}})"
+        "\r\n" R"({"type": "Feature", "geometry": {"type": "MultiPoint", "coordinates": [[5.3, 52.3], [5.4, 52.4]]},)"
+        R"( "properties": {"id": 2}})";
+
+    auto fc = vectkit::read_seq_from_buffer(text);
+    CHECK(fc.heading.yaw == doctest::Approx(0.5));
+    REQUIRE(fc.features.size() == 4);
+    CHECK(fc.features[0].properties.at("id") == "0");
+    CHECK_FALSE(fc.features[0].properties.contains("datum"));
+    CHECK(fc.features[1].properties.at("id") == "1");
+    CHECK(fc.features[3].properties.at("id") == "2");
+
+    vectkit::ReadOptions options;
+    options.filter = [](const vectkit::Properties::Map &props) { return props.at("id").as_int() != 1; };
+    options.keep_multipart = true;
+    auto filtered = vectkit::read_seq_from_buffer(text, options);
+    REQUIRE(filtered.features.size() == 2);
+    CHECK(std::holds_alternative<vectkit::MultiPoint>(filtered.features[1].geometry));
+}
+
+TEST_CASE("Seq - Threaded read") {
+    const std::filesystem::path test_file = "/tmp/test_seq_threaded.geojsons";
+    auto log = point_log(5000);
+    write_bytes(test_file, log);
+
+    auto serial = vectkit::read_seq(test_file);
+    auto threaded = vectkit::read_seq(test_file, {.threads = 4});
+    REQUIRE(serial.features.size() == 5000);
+    REQUIRE(threaded.features.size() == serial.features.size());
+    for (size_t i = 0; i < serial.features.size(); ++i) {
+        CHECK(serial.features[i].properties == threaded.features[i].properties);
+        CHECK(std::get<dp::Point>(serial.features[i].geometry).x ==
+              std::get<dp::Point>(threaded.features[i].geometry).x);
+    }
+
+    vectkit::ReadOptions lazy;
+    lazy.threads = 4;
+    lazy.lazy_properties = true;
+    auto deferred = vectkit::read_seq(test_file, lazy);
+    REQUIRE(deferred.features.size() == serial.features.size());
+    CHECK(deferred.features.back().properties == serial.features.back().properties);
+
+    // The first bad record in file order is reported, whatever the thread count
+    auto bad = log;
+    bad.replace(bad.find(R"("id": 100,)"), 10, R"("id": 100 )");
+    bad.replace(bad.find("[5.004000, 52.0]"), 16, "[5.004000]");
+    write_bytes(test_file, bad);
+    CHECK_THROWS_WITH(vectkit::read_seq(test_file, {.threads = 4}),
+                      doctest::Contains("vectkit::ReadFeatureSeq(): failed to parse JSON"));
+    CHECK_THROWS_WITH(vectkit::read_seq(test_file), doctest::Contains("vectkit::ReadFeatureSeq(): failed"));
+
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Seq - Incomplete last record") {
+    auto log = point_log(3000);
+    auto whole = vectkit::read_seq_from_buffer(log);
+    REQUIRE(whole.features.size() == 3000);
+
+    // Cut inside the last record, as by a writer interrupted mid-write: that record is skipped
+    auto cut = log.substr(0, log.size() - 40);
+    for (size_t threads : {size_t(1), size_t(4)}) {
+        auto fc = vectkit::read_seq_from_buffer(cut, {.threads = threads});
+        REQUIRE(fc.features.size() == 2999);
+        CHECK(fc.features.back().properties == whole.features[2998].properties);
+    }
+    // Cut right after a record separator, or in a newline-delimited file
+    CHECK(vectkit::read_seq_from_buffer(log + "\x1e{\"type\": \"Fea").features.size() == 3000);
+    std::string lines = log;
+    lines.erase(std::remove(lines.begin(), lines.end(), '\x1e'), lines.end());
+    CHECK(vectkit::read_seq_from_buffer(lines.substr(0, lines.size() - 40)).features.size() == 2999);
+
+    // A complete last record without a line feed is kept, and one that ends with its line feed must parse
+    CHECK(vectkit::read_seq_from_buffer(log.substr(0, log.size() - 1)).features.size() == 3000);
+    CHECK_THROWS_WITH(vectkit::read_seq_from_buffer(cut + "\n"), doctest::Contains("failed to parse JSON"));
+}
+
+TEST_CASE("Seq - Write options") {
+    auto fc = vectkit::ReadFeatureCollection(PROJECT_DIR "/misc/wur.geojson");
+    const std::filesystem::path test_file = "/tmp/test_seq_options.geojsons";
+
+    std::string serial, threaded;
+    vectkit::write_seq_to_buffer(fc, serial, vectkit::CRS::WGS);
+    vectkit::write_seq_to_buffer(fc, threaded, {.crs = vectkit::CRS::WGS, .threads = 4});
+    CHECK(threaded == serial);
+    vectkit::write_seq(fc, test_file, {.crs = vectkit::CRS::WGS, .threads = 4});
+    CHECK(read_bytes(test_file) == serial);
+
+    // Rounded coordinates, as for the plain format
+    vectkit::WriteOptions rounded{.crs = vectkit::CRS::ENU, .threads = 3, .enu_decimals = 2};
+    vectkit::write_seq(fc, test_file, rounded);
+    std::string plain;
+    vectkit::write_to_buffer(fc, plain, rounded);
+    auto back = vectkit::read_seq(test_file);
+    CHECK(vectkit::write_to_string(back) == vectkit::write_to_string(vectkit::read_from_buffer(plain)));
+
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Seq - Errors") {
+    CHECK_THROWS_WITH(vectkit::read_seq("/nonexistent/file.geojsons"),
+                      doctest::Contains("vectkit::ReadFeatureSeq(): cannot open"));
+    CHECK_THROWS_WITH(vectkit::read_seq_from_buffer("\x1e\n\n"), "vectkit::ReadFeatureSeq(): no header record");
+    CHECK_THROWS_WITH(vectkit::read_seq_from_buffer(R"({"type": "FeatureCollection", "features": []})"),
+                      doctest::Contains("missing top-level 'properties'"));
+
+    const std::string header = R"({"type": "FeatureCollection", "features": [], "properties": {"crs": "ENU",)"
+                               R"( "datum": [5.0, 52.0, 0.0], "heading": 0.0}})";
+    CHECK_THROWS_WITH(vectkit::read_seq_from_buffer(header + "\n[1, 2]"), doctest::Contains("expected a Feature"));
+    CHECK_THROWS_WITH(vectkit::read_seq_from_buffer(header + "\n{\"type\": \"Feature\"} {}"),
+                      doctest::Contains("unexpected trailing characters"));
+}
@@ -0,0 +1,128 @@
+#include <doctest/doctest.h>
+
+#include "vectkit/vectkit.hpp"
+#include <filesystem>
+#include <fstream>
+
+namespace dp = ::datapod;
+
+namespace {
+    const std::string header_last = R"({
+        "type": "FeatureCollection",
+        "features": [
+            {"type": "Feature", "geometry": {"type": "Point", "coordinates": [5.1, 52.1]}, "properties": {"id": 1}},
+            {"type": "Feature", "geometry": null, "properties": {"id": 2}},
+            {"type": "Feature", "geometry": {"type": "MultiPoint", "coordinates": [[5.1, 52.1], [5.2, 52.2]]},
+             "properties": {"id": 3}}
+        ],
+        "properties": {"crs": "EPSG:4326", "datum": [5.0, 52.0, 0.0], "heading": 1.5, "field": "north"}
+    })";
+
+    void write_file(const std::filesystem::path &path, const std::string &content) {
+        std::ofstream ofs(path);
+        ofs << content;
+    }
+} // namespace
+
+TEST_CASE("Stream - Matches ReadFeatureCollection") {
+    auto path = PROJECT_DIR "/misc/wur.geojson";
+    auto fc = vectkit::ReadFeatureCollection(path);
+
+    SUBCASE("Default chunk size") {
+        vectkit::FeatureReader reader(path);
+        CHECK(reader.datum().latitude == doctest::Approx(fc.datum.latitude));
+        CHECK(reader.heading().yaw == doctest::Approx(fc.heading.yaw));
+        CHECK(reader.crs() == vectkit::CRS::WGS);
+
+        size_t i = 0;
+        for (auto &f : reader) {
+            REQUIRE(i < fc.features.size());
+            CHECK(f.geometry.index() == fc.features[i].geometry.index());
+            CHECK(f.properties == fc.features[i].properties);
+            ++i;
+        }
+        CHECK(i == fc.features.size());
+    }
+
+    SUBCASE("Tiny chunks split every token") {
+        vectkit::FeatureReader reader(path, 7);
+        size_t i = 0;
+        vectkit::Feature f;
+        while (reader.next(f)) {
+            REQUIRE(i < fc.features.size());
+            CHECK(f.properties == fc.features[i].properties);
+            if (auto *poly = std::get_if<dp::Polygon>(&f.geometry)) {
+                auto &expected = std::get<dp::Polygon>(fc.features[i].geometry);
+                REQUIRE(poly->vertices.size() == expected.vertices.size());
+                CHECK(poly->vertices[0].x == doctest::Approx(expected.vertices[0].x));
+            }
+            ++i;
+        }
+        CHECK(i == fc.features.size());
+    }
+}
+
+TEST_CASE("Stream - Header after features") {
+    const std::filesystem::path test_file = "/tmp/test_stream_header_last.geojson";
+    write_file(test_file, header_last);
+
+    std::vector<vectkit::Feature> seen;
+    auto header = vectkit::read(test_file, [&](vectkit::Feature &&f) { seen.push_back(std::move(f)); });
+
+    CHECK(header.datum.latitude == doctest::Approx(52.0));
+    CHECK(header.heading.yaw == doctest::Approx(1.5));
+    CHECK(header.global_properties.at("field") == "north");
+    CHECK(header.features.empty());
+
+    // The null geometry is skipped and the MultiPoint is flattened, exactly like the DOM reader
+    REQUIRE(seen.size() == 3);
+    CHECK(seen[0].properties.at("id") == "1");
+    CHECK(seen[1].properties.at("id") == "3");
+    CHECK(seen[2].properties.at("id") == "3");
+    CHECK(std::holds_alternative<dp::Point>(seen[2].geometry));
+
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Stream - Errors") {
+    const std::filesystem::path test_file = "/tmp/test_stream_errors.geojson";
+
+    SUBCASE("Nonexistent file") {
+        CHECK_THROWS_WITH(vectkit::FeatureReader("/nonexistent/file.geojson"),
+                          doctest::Contains("vectkit::FeatureReader(): cannot open"));
+    }
+
+    SUBCASE("Missing properties") {
+        write_file(test_file, R"({"type": "FeatureCollection", "features": []})");
+        CHECK_THROWS_WITH(vectkit::FeatureReader{test_file}, "missing top-level 'properties'");
+    }
+
+    SUBCASE("Malformed header") {
+        // Structurally whole, so only the header's JSON parse catches it
+        const std::string text = R"({"type": "FeatureCollection",
+            "properties": {"crs": "ENU", "datum": [5.0, 52.0, 0.0], "heading": 1.2.3}, "features": []})";
+        write_file(test_file, text);
+        CHECK_THROWS_WITH(vectkit::FeatureReader{test_file},
+                          doctest::Contains("vectkit::FeatureReader(): failed to parse JSON: invalid 'properties': "
+                                            "invalid number at offset"));
+        CHECK_THROWS_WITH(vectkit::read_from_buffer(text),
+                          doctest::Contains("failed to parse JSON: invalid 'properties': invalid number at offset"));
+    }
+
+    SUBCASE("Missing type") {
+        write_file(test_file, R"({"features": []})");
+        CHECK_THROWS_WITH(vectkit::FeatureReader{test_file},
+                          "vectkit::FeatureReader(): top-level object has no string 'type' field");
+    }
+
+    SUBCASE("Truncated feature") {
+        write_file(test_file, R"({"type": "FeatureCollection",
+            "properties": {"crs": "ENU", "datum": [5.0, 52.0, 0.0], "heading": 0.0},
+            "features": [{"type": "Feature", "geometry": {"type": "Point", "coordinates": [1.0, 2.0]})");
+        vectkit::FeatureReader reader(test_file);
+        vectkit::Feature f;
+        CHECK_THROWS(reader.next(f));
+    }
+
+    std::filesystem::remove(test_file);
+}
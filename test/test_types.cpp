@@ -1,6 +1,7 @@
 #include <doctest/doctest.h>
 
 #include "vectkit/vectkit.hpp"
+#include <string>
 #include <variant>
 
 namespace dp = ::datapod;
@@ -134,3 +135,96 @@ TEST_CASE("Types - FeatureCollection") {
     CHECK(std::holds_alternative<dp::Segment>(fc.features[1].geometry));
     CHECK(fc.features[1].properties["name"] == "test_line");
 }
+
+TEST_CASE("Types - Shared properties") {
+    vectkit::Properties a{{"name", "row"}, {"crop", "wheat"}};
+    vectkit::Properties b = a;
+    CHECK(b.shares(a));
+    CHECK(b == a);
+
+    // The first write detaches the copy; the original is untouched
+    b["crop"] = "maize";
+    CHECK_FALSE(b.shares(a));
+    CHECK(a.at("crop") == "wheat");
+    CHECK(b.at("crop") == "maize");
+    CHECK(b.at("name") == "row");
+
+    // A copy that is no longer shared is written in place
+    vectkit::Properties c = b;
+    c = {};
+    b["id"] = "7";
+    CHECK(b.size() == 3);
+
+    vectkit::Properties empty;
+    CHECK(empty.empty());
+    CHECK(empty.begin() == empty.end());
+    CHECK(empty.find("name") == empty.end());
+    CHECK(empty == vectkit::Properties{});
+    CHECK(empty.erase("name") == 0);
+}
+
+TEST_CASE("Types - Property values") {
+    vectkit::PropertyValue n = 42, x = 2.5, b = true, s = "row", none;
+    auto raw = vectkit::PropertyValue::raw(R"([1,2])");
+
+    CHECK(n.is_int());
+    CHECK(n.is_number());
+    CHECK(n.as_int() == 42);
+    CHECK(n.as_number() == 42.0);
+    CHECK(x.as_number() == 2.5);
+    CHECK(b.as_bool());
+    CHECK(s.as_string() == "row");
+    CHECK(none.is_null());
+    CHECK(raw.as_raw() == "[1,2]");
+    CHECK_THROWS_AS(s.as_number(), std::runtime_error);
+    CHECK_THROWS_AS(x.as_int(), std::runtime_error);
+
+    // Compared with strings through their JSON text
+    CHECK(n == "42");
+    CHECK(x == "2.5");
+    CHECK(b == "true");
+    CHECK(none == "null");
+    CHECK(raw == "[1,2]");
+    CHECK(vectkit::PropertyValue(3.0).text() == "3.0");
+    CHECK(vectkit::PropertyValue(0.1).text() == "0.1");
+
+    CHECK(n == vectkit::PropertyValue(42.0));
+    CHECK_FALSE(s == vectkit::PropertyValue::raw("row"));
+}
+
+// Fills the process-wide key table, so it stays the last case in this file
+TEST_CASE("Types - Key table is bounded") {
+    using vectkit::PropertyKey;
+    PropertyKey early("row");
+    CHECK(early.interned());
+
+    size_t i = 0;
+    while (PropertyKey("key_" + std::to_string(i)).interned())
+        ++i;
+    CHECK(vectkit::detail::KeyTable::instance().size() <= vectkit::detail::KeyTable::max_names);
+
+    // Names already in the table are still shared; new ones get keys that compare by text
+    CHECK(PropertyKey("row") == early);
+    PropertyKey a("late"), b(std::string("late"));
+    CHECK_FALSE(a.interned());
+    CHECK(a == b);
+    CHECK(std::hash<PropertyKey>()(a) == std::hash<PropertyKey>()(b));
+    CHECK_FALSE(a == PropertyKey("later"));
+    CHECK(a.name() == "late");
+
+    PropertyKey copy = a;
+    a = early;
+    CHECK(copy == b);
+    CHECK(a == early);
+
+    vectkit::Properties props{{"late", 1}, {"row", "wheat"}};
+    CHECK(props.at(b).as_int() == 1);
+    CHECK(props.at("late").as_int() == 1);
+    CHECK(props.at(early) == "wheat");
+
+    auto fc = vectkit::read_from_buffer(R"({"type": "FeatureCollection", "properties": {"crs": "ENU",
+        "datum": [5.0, 52.0, 0.0], "heading": 0.0}, "features": [{"type": "Feature", "geometry":
+        {"type": "Point", "coordinates": [1, 2]}, "properties": {"unseen": 3, "late": 4}}]})");
+    CHECK(fc.features[0].properties.at("unseen").as_int() == 3);
+    CHECK(fc.features[0].properties.at(b).as_int() == 4);
+}
@@ -1,8 +1,14 @@
 #include <doctest/doctest.h>
 
 #include "vectkit/vectkit.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 
 namespace dp = ::datapod;
 
@@ -78,6 +84,26 @@ TEST_CASE("Writer - Write and read back") {
         std::filesystem::remove(test_file);
     }
 
+    SUBCASE("Rewrite is byte-identical") {
+        fc.global_properties = {{"zone", "north"}, {"version", 3}, {"area", 1.5}, {"crop", "wheat"}};
+        const std::filesystem::path again_file = "/tmp/test_output_again.geojson";
+        vectkit::write(fc, test_file, vectkit::CRS::WGS);
+        auto loaded_fc = vectkit::read(test_file);
+        vectkit::write(loaded_fc, again_file, vectkit::CRS::WGS);
+
+        auto slurp = [](const std::filesystem::path &path) {
+            std::ifstream in(path, std::ios::binary);
+            return std::string(std::istreambuf_iterator<char>(in), {});
+        };
+        std::string first = slurp(test_file);
+        CHECK(slurp(again_file) == first);
+        // Global properties keep the order they were set in
+        CHECK(first.find(R"("zone":"north","version":3,"area":1.5,"crop":"wheat")") != std::string::npos);
+
+        std::filesystem::remove(test_file);
+        std::filesystem::remove(again_file);
+    }
+
     SUBCASE("Write to invalid path throws") {
         CHECK_THROWS_AS(vectkit::write(fc, "/invalid/path/file.geojson"), std::runtime_error);
     }
@@ -112,3 +138,433 @@ TEST_CASE("Writer - Default CRS output") {
         std::filesystem::remove(test_file);
     }
 }
+
+TEST_CASE("Writer - In-memory buffers") {
+    dp::Geo datum{52.0, 5.0, 0.0};
+    std::vector<vectkit::Feature> features;
+    features.emplace_back(vectkit::Feature{dp::Point{10.0, 20.0, 0.5}, {{"name", "a \"quoted\" name"}}});
+    features.emplace_back(vectkit::Feature{dp::Segment{dp::Point{0, 0, 0}, dp::Point{1, 1, 0}}, {}});
+    vectkit::FeatureCollection fc{datum, dp::Euler{0.0, 0.0, 0.25}, std::move(features), {{"site", "wur"}}};
+
+    std::string buffer;
+    vectkit::write_to_buffer(fc, buffer, vectkit::CRS::ENU);
+    CHECK(buffer == vectkit::toJson(fc, vectkit::CRS::ENU));
+    CHECK(vectkit::write_to_string(fc) == vectkit::toJson(fc, vectkit::CRS::WGS));
+
+    // Rewriting replaces the contents and keeps the storage
+    const char *storage = buffer.data();
+    vectkit::write_to_buffer(fc, buffer, vectkit::CRS::ENU);
+    CHECK(buffer.data() == storage);
+    CHECK(buffer == vectkit::toJson(fc, vectkit::CRS::ENU));
+
+    SUBCASE("Read back from every buffer type") {
+        std::vector<char> bytes(buffer.begin(), buffer.end());
+        std::vector<vectkit::FeatureCollection> loaded;
+        loaded.push_back(vectkit::read_from_buffer(buffer));
+        loaded.push_back(vectkit::read_from_buffer(std::string_view(buffer)));
+        loaded.push_back(vectkit::read_from_buffer(std::span<const char>(bytes)));
+        loaded.push_back(vectkit::read_from_buffer(buffer.c_str()));
+
+        for (const auto &l : loaded) {
+            CHECK(l.datum.latitude == doctest::Approx(52.0));
+            CHECK(l.heading.yaw == doctest::Approx(0.25));
+            CHECK(l.global_properties.at("site") == "wur");
+            REQUIRE(l.features.size() == 2);
+            CHECK(l.features[0].properties.at("name") == "a \"quoted\" name");
+            CHECK(std::get<dp::Point>(l.features[0].geometry).y == doctest::Approx(20.0));
+            CHECK(std::holds_alternative<dp::Segment>(l.features[1].geometry));
+        }
+    }
+
+    SUBCASE("Only the given bytes are read") {
+        std::string padded = buffer + "garbage";
+        CHECK(vectkit::read_from_buffer(std::string_view(padded).substr(0, buffer.size())).features.size() == 2);
+        CHECK_THROWS_WITH(vectkit::read_from_buffer(padded),
+                          doctest::Contains("vectkit::ReadFeatureCollection(): failed to parse JSON"));
+    }
+}
+
+TEST_CASE("Writer - Typed properties") {
+    const std::string text = R"({"type": "FeatureCollection", "properties": {"crs": "ENU", "datum": [5.0, 52.0, 0.0],
+        "heading": 0.0}, "features": [{"type": "Feature", "geometry": {"type": "Point", "coordinates": [1, 2]},
+        "properties": {"count": 42, "width": 2.50, "big": 1e300, "huge": 1e400, "tiny": -1e-400, "ok": false,
+        "gone": null, "name": "a", "tags": [1, "two", {"x": 3}]}}]})";
+    auto fc = vectkit::read_from_buffer(text);
+    const auto &props = fc.features[0].properties;
+    CHECK(props.at("count").as_int() == 42);
+    CHECK(props.at("width").as_number() == 2.5);
+    CHECK(props.at("big").as_number() == 1e300);
+    CHECK(props.at("huge").as_raw() == "1e400"); // beyond a double: kept as written, not saturated
+    CHECK(props.at("tiny").as_raw() == "-1e-400");
+    CHECK_FALSE(props.at("ok").as_bool());
+    CHECK(props.at("gone").is_null());
+    CHECK(props.at("tags").as_raw() == R"([1,"two",{"x":3}])");
+
+    // Written with their JSON types; reading them back gives the same values and the same bytes
+    std::string once = vectkit::toJson(fc, vectkit::CRS::ENU);
+    auto again = vectkit::read_from_buffer(once);
+    CHECK(again.features[0].properties == props);
+    std::string twice = vectkit::toJson(again, vectkit::CRS::ENU);
+    for (const char *member : {R"("count":42)", R"("width":2.5)", R"("big":1e+300)", R"("huge":1e400)",
+                               R"("tiny":-1e-400)", R"("ok":false)", R"("gone":null)", R"("name":"a")",
+                               R"("tags":[1,"two",{"x":3}])"}) {
+        CHECK(once.find(member) != std::string::npos);
+        CHECK(twice.find(member) != std::string::npos);
+    }
+    CHECK(twice == once); // properties keep their order
+}
+
+TEST_CASE("Writer - Typed global properties") {
+    const std::string text = R"({"type": "FeatureCollection", "properties": {"crs": "ENU", "datum": [5.0, 52.0, 0.0],
+        "heading": 0.0, "version": 3, "scale": 0.5, "huge": 1e400, "draft": true, "owner": null,
+        "name": "say \"hi\"", "tags": ["a", "b\n"], "meta": {"k": [1, 2]}}, "features": [{"type": "Feature",
+        "geometry": {"type": "Point", "coordinates": [1, 2]}, "properties": {}}]})";
+    auto fc = vectkit::read_from_buffer(text);
+    const auto &global = fc.global_properties;
+    CHECK(global.at("version").as_int() == 3);
+    CHECK(global.at("scale").as_number() == 0.5);
+    CHECK(global.at("huge").as_raw() == "1e400");
+    CHECK(global.at("draft").as_bool());
+    CHECK(global.at("owner").is_null());
+    CHECK(global.at("name").as_string() == "say \"hi\"");
+    CHECK(global.at("tags").as_raw() == R"(["a","b\n"])");
+    CHECK(global.at("meta").as_raw() == R"({"k":[1,2]})");
+
+    // Written with their types, not as quoted strings, and read back unchanged
+    std::string once = vectkit::toJson(fc, vectkit::CRS::ENU);
+    for (const char *member : {R"("version":3)", R"("scale":0.5)", R"("huge":1e400)", R"("draft":true)",
+                               R"("owner":null)", R"("name":"say \"hi\"")", R"("tags":["a","b\n"])",
+                               R"("meta":{"k":[1,2]})"}) {
+        CHECK(once.find(member) != std::string::npos);
+    }
+    auto again = vectkit::read_from_buffer(once);
+    CHECK(again.global_properties == global);
+    CHECK(vectkit::toJson(again, vectkit::CRS::ENU) == once);
+}
+
+TEST_CASE("Writer - Control characters are escaped") {
+    const std::string value = std::string("a\x01") + "b\x1f\n\t\"c";
+    vectkit::FeatureCollection fc{dp::Geo{52.0, 5.0, 0.0}, dp::Euler{0, 0, 0}, {}, {{"note", value}}};
+    fc.features.push_back(vectkit::Feature{dp::Point{1.0, 2.0, 0.0}, {{"name", value}, {std::string("k\x02"), 1}}});
+
+    std::string text = vectkit::toJson(fc, vectkit::CRS::ENU);
+    CHECK(text.find(R"("a\u0001b\u001f\n\t\"c")") != std::string::npos);
+    CHECK(std::none_of(text.begin(), text.end(), [](char c) { return static_cast<unsigned char>(c) < 0x20; }));
+
+    const std::filesystem::path test_file = "/tmp/test_writer_control.geojson";
+    vectkit::write(fc, test_file, vectkit::CRS::ENU);
+    auto back = vectkit::read(test_file);
+    REQUIRE(back.features.size() == 1);
+    CHECK(back.features[0].properties.at("name").as_string() == value);
+    CHECK(back.features[0].properties.at(std::string("k\x02")).as_int() == 1);
+    CHECK(back.global_properties.at("note").as_string() == value);
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Writer - Streaming FeatureWriter") {
+    auto fc = vectkit::ReadFeatureCollection(PROJECT_DIR "/misc/wur.geojson");
+    const std::filesystem::path expected_file = "/tmp/test_writer_expected.geojson";
+    const std::filesystem::path test_file = "/tmp/test_writer_stream.geojson";
+    vectkit::WriteFeatureCollection(fc, expected_file, vectkit::CRS::ENU);
+
+    auto read_bytes = [](const std::filesystem::path &path) {
+        std::ifstream ifs(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    };
+    const std::string expected = read_bytes(expected_file);
+    CHECK(expected == vectkit::toJson(fc, vectkit::CRS::ENU) + "\n");
+
+    SUBCASE("Same file for any buffer size") {
+        for (size_t buffer_size : {size_t(1), size_t(100), size_t(1) << 20}) {
+            vectkit::FeatureWriter writer(test_file, fc, vectkit::CRS::ENU, buffer_size);
+            for (const auto &f : fc.features)
+                writer.write(f);
+            CHECK(writer.count() == fc.features.size());
+            writer.close();
+            CHECK(read_bytes(test_file) == expected);
+        }
+    }
+
+    SUBCASE("Destructor ends the document") {
+        {
+            vectkit::FeatureWriter writer(test_file, fc, vectkit::CRS::ENU, 64);
+            for (const auto &f : fc.features)
+                writer.write(f);
+        }
+        CHECK(read_bytes(test_file) == expected);
+    }
+
+    SUBCASE("Abandoned on error leaves the document open") {
+        try {
+            vectkit::FeatureWriter writer(test_file, fc, vectkit::CRS::ENU, 64);
+            for (const auto &f : fc.features)
+                writer.write(f);
+            throw std::runtime_error("producer failed");
+        } catch (const std::runtime_error &) {
+        }
+        const std::string partial = read_bytes(test_file);
+        CHECK(partial.size() < expected.size());
+        CHECK(expected.starts_with(partial));
+        CHECK_THROWS(vectkit::ReadFeatureCollection(test_file));
+    }
+
+    SUBCASE("Failed write is not closed by the destructor") {
+        // Every flush to /dev/full fails, so the destructor must not try to end the document
+        vectkit::FeatureWriter writer("/dev/full", fc, vectkit::CRS::ENU, 1);
+        CHECK_THROWS(writer.write(fc.features.front()));
+    }
+
+    SUBCASE("No features") {
+        vectkit::FeatureWriter writer(test_file, fc);
+        writer.close();
+        auto back = vectkit::ReadFeatureCollection(test_file);
+        CHECK(back.features.empty());
+        CHECK(back.datum.latitude == doctest::Approx(fc.datum.latitude));
+    }
+
+    SUBCASE("Invalid path") {
+        CHECK_THROWS_WITH(vectkit::FeatureWriter("/nonexistent/directory/file.geojson", fc),
+                          doctest::Contains("Cannot open for write"));
+    }
+
+    std::filesystem::remove(expected_file);
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Writer - Coordinates round-trip exactly") {
+    // Values that 15 significant digits cannot tell apart from their neighbours
+    const std::vector<dp::Point> points{{0.1 + 0.2, 1.0 / 3.0, 2.0 / 3.0},
+                                        {123456.78901234567, -0.000123456789012345678, 1e-300},
+                                        {5.0, -0.0, 1e21}};
+    vectkit::FeatureCollection fc{dp::Geo{51.987654321012345, 5.6543210987654321, 12.345678901234567},
+                                  dp::Euler{0.0, 0.0, 0.1 + 0.7}, {}, {}};
+    fc.features.push_back(vectkit::Feature{points, {}});
+
+    auto text = vectkit::toJson(fc, vectkit::CRS::ENU);
+    CHECK(text.find("[5,-0,1e+21]") != std::string::npos); // shortest form, no padding digits
+    CHECK(text.find("0.30000000000000004") != std::string::npos);
+
+    auto back = vectkit::read_from_buffer(text);
+    CHECK(back.datum.latitude == fc.datum.latitude);
+    CHECK(back.datum.longitude == fc.datum.longitude);
+    CHECK(back.datum.altitude == fc.datum.altitude);
+    CHECK(back.heading.yaw == fc.heading.yaw);
+    const auto &path = std::get<std::vector<dp::Point>>(back.features[0].geometry);
+    REQUIRE(path.size() == points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        CHECK(path[i].x == points[i].x);
+        CHECK(path[i].y == points[i].y);
+        CHECK(path[i].z == points[i].z);
+    }
+}
+
+TEST_CASE("Writer - Parallel serialization") {
+    // Enough features that small buffers split them into many chunks and batches
+    auto wur = vectkit::ReadFeatureCollection(PROJECT_DIR "/misc/wur.geojson");
+    vectkit::FeatureCollection fc{wur.datum, wur.heading, {}, wur.global_properties};
+    while (fc.features.size() < 2000)
+        fc.features.insert(fc.features.end(), wur.features.begin(), wur.features.end());
+
+    auto read_bytes = [](const std::filesystem::path &path) {
+        std::ifstream ifs(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    };
+    const std::filesystem::path test_file = "/tmp/test_writer_parallel.geojson";
+
+    for (auto crs : {vectkit::CRS::WGS, vectkit::CRS::ENU}) {
+        const std::string expected = vectkit::toJson(fc, crs);
+
+        for (size_t threads : {size_t(1), size_t(2), size_t(4), size_t(0)}) {
+            std::string buffer;
+            vectkit::write_to_buffer(fc, buffer, vectkit::WriteOptions{.crs = crs, .threads = threads});
+            CHECK(buffer == expected);
+
+            vectkit::write(fc, test_file, vectkit::WriteOptions{.crs = crs, .threads = threads});
+            CHECK(read_bytes(test_file) == expected + "\n");
+
+            // Small buffers: many batches, some chunks of one feature
+            {
+                vectkit::FeatureWriter writer(test_file, fc, vectkit::WriteOptions{.crs = crs, .threads = threads},
+                                              4096);
+                writer.write(fc.features[0]);
+                writer.write_all(std::span(fc.features).subspan(1));
+                CHECK(writer.count() == fc.features.size());
+                writer.close();
+            }
+            CHECK(read_bytes(test_file) == expected + "\n");
+        }
+    }
+
+    // A sink that fails part-way stops the write; the worker threads are still joined
+    size_t pieces = 0;
+    auto failing = [&](std::string_view) {
+        if (++pieces == 5)
+            throw std::runtime_error("sink full");
+    };
+    CHECK_THROWS_WITH(vectkit::write_to_sink(fc, failing, {.threads = 4}, 4096), "sink full");
+    CHECK(pieces == 5);
+
+    vectkit::FeatureCollection empty{wur.datum, wur.heading, {}, {}};
+    vectkit::write(empty, test_file, vectkit::WriteOptions{.threads = 4});
+    CHECK(read_bytes(test_file) == vectkit::toJson(empty, vectkit::CRS::WGS) + "\n");
+
+    std::filesystem::remove(test_file);
+}
+
+TEST_CASE("Writer - Sinks") {
+    auto fc = vectkit::ReadFeatureCollection(PROJECT_DIR "/misc/wur.geojson");
+    const std::string expected = vectkit::toJson(fc, vectkit::CRS::ENU);
+
+    SUBCASE("Callback") {
+        for (size_t threads : {size_t(1), size_t(4)}) {
+            std::string joined;
+            size_t pieces = 0;
+            vectkit::write_to_sink(
+                fc,
+                [&](std::string_view piece) {
+                    joined += piece;
+                    ++pieces;
+                },
+                vectkit::WriteOptions{.crs = vectkit::CRS::ENU, .threads = threads}, 256);
+            CHECK(joined == expected);
+            CHECK(pieces > 1);
+        }
+    }
+
+    SUBCASE("File descriptor") {
+        const std::filesystem::path test_file = "/tmp/test_writer_fd.geojson";
+        std::FILE *file = std::fopen(test_file.c_str(), "w");
+        REQUIRE(file != nullptr);
+        vectkit::write_to_fd(fc, fileno(file), vectkit::WriteOptions{.crs = vectkit::CRS::ENU});
+        std::fclose(file);
+        std::ifstream ifs(test_file, std::ios::binary);
+        CHECK(std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()) == expected);
+        std::filesystem::remove(test_file);
+
+        CHECK_THROWS_WITH(vectkit::write_to_fd(fc, -1), doctest::Contains("write failed"));
+    }
+
+    SUBCASE("Appending one feature") {
+        std::string out = "[";
+        vectkit::write_feature(out, fc.features[0], fc.datum, vectkit::CRS::ENU);
+        out += ',';
+        vectkit::write_geometry(out, fc.features[0].geometry, fc.datum, vectkit::CRS::ENU);
+        out += ']';
+        CHECK(out == "[" + vectkit::featureToJson(fc.features[0], fc.datum, vectkit::CRS::ENU) + "," +
+                         vectkit::geometryToJson(fc.features[0].geometry, fc.datum, vectkit::CRS::ENU) + "]");
+    }
+}
+
+TEST_CASE("Writer - Fixed decimal places") {
+    const std::vector<dp::Point> points{{1.23456, 2.0, -0.0004}, {-1.5, 0.0996, 123456.78949}, {1e17, -2.5e-7, 0.1}};
+    vectkit::FeatureCollection fc{dp::Geo{51.987654321012345, 5.6543210987654321, 12.345678901234567},
+                                  dp::Euler{0.0, 0.0, 0.1 + 0.7}, {}, {}};
+    fc.features.push_back(vectkit::Feature{points, {}});
+
+    std::string text;
+    vectkit::write_to_buffer(fc, text, vectkit::WriteOptions{.crs = vectkit::CRS::ENU, .enu_decimals = 3});
+    // Rounded, trailing zeros dropped, no negative zero; too large for the integer path still exact
+    CHECK(text.find("[[1.235,2,0],[-1.5,0.1,123456.789],[100000000000000000,0,0.1]]") != std::string::npos);
+    // The datum and heading are not quantized
+    auto back = vectkit::read_from_buffer(text);
+    CHECK(back.datum.latitude == fc.datum.latitude);
+    CHECK(back.heading.yaw == fc.heading.yaw);
+
+    std::string zero;
+    vectkit::write_to_buffer(fc, zero, vectkit::WriteOptions{.crs = vectkit::CRS::ENU, .enu_decimals = 0});
+    CHECK(zero.find("[[1,2,0],[-2,0,123457],") != std::string::npos);
+
+    // Options for the other CRS do not apply
+    std::string exact;
+    vectkit::write_to_buffer(fc, exact, vectkit::WriteOptions{.crs = vectkit::CRS::ENU, .wgs_decimals = 3});
+    CHECK(exact == vectkit::toJson(fc, vectkit::CRS::ENU));
+
+    CHECK_THROWS_AS(vectkit::write_to_buffer(fc, text, vectkit::WriteOptions{.wgs_decimals = 16}),
+                    std::invalid_argument);
+}
+
+TEST_CASE("Writer - Fixed decimal places match std::to_chars") {
+    // The correctly rounded text, trimmed the way the writer trims it
+    auto reference = [](double v, int decimals) {
+        char buf[400];
+        char *end = std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::fixed, decimals).ptr;
+        std::string text(buf, end);
+        if (decimals > 0) {
+            text.erase(text.find_last_not_of('0') + 1);
+            if (text.back() == '.')
+                text.pop_back();
+        }
+        return text == "-0" ? std::string("0") : text;
+    };
+    auto fixed = [](double v, int decimals) {
+        std::string out;
+        vectkit::detail::append_fixed(out, v, decimals);
+        return out;
+    };
+
+    // Off by one ulp with a scaled integer at many places, and ties of the decimal text whose exact
+    // binary value is just below or above the tie
+    CHECK(fixed(-302.3595, 13) == reference(-302.3595, 13));
+    CHECK(fixed(-596.3895, 3) == "-596.389");
+    CHECK(fixed(0.125, 2) == "0.12"); // an exact tie rounds to even
+    CHECK(fixed(2.5, 0) == "2");
+    CHECK(fixed(-0.0004, 3) == "0");
+
+    std::uint64_t state = 0x9e3779b97f4a7c15;
+    auto next = [&] {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    size_t mismatches = 0;
+    for (int i = 0; i < 200000; ++i) {
+        int decimals = static_cast<int>(next() % 16);
+        double v;
+        if (i % 2) {
+            // Decimal ties: a number with decimals + 1 places ending in 5
+            auto digits = static_cast<std::int64_t>(next() % 100000000000) * 10 + 5;
+            v = static_cast<double>(digits) / std::pow(10.0, decimals + 1);
+        } else {
+            v = std::ldexp(static_cast<double>(next() >> 11), -static_cast<int>(next() % 60));
+        }
+        if (next() % 2)
+            v = -v;
+        mismatches += fixed(v, decimals) != reference(v, decimals);
+    }
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE("Writer - Quantized WGS output") {
+    auto fc = vectkit::ReadFeatureCollection(PROJECT_DIR "/misc/wur.geojson");
+    const std::filesystem::path test_file = "/tmp/test_writer_quantized.geojson";
+    vectkit::WriteOptions options{.crs = vectkit::CRS::WGS, .threads = 2, .wgs_decimals = 8};
+
+    std::string exact = vectkit::toJson(fc, vectkit::CRS::WGS);
+    std::string quantized;
+    vectkit::write_to_buffer(fc, quantized, options);
+    CHECK(quantized.size() < exact.size());
+
+    vectkit::write(fc, test_file, options);
+    auto back = vectkit::ReadFeatureCollection(test_file);
+    REQUIRE(back.features.size() == fc.features.size());
+    // 1e-8 degrees is about a millimetre
+    for (size_t i = 0; i < fc.features.size(); ++i) {
+        const auto *a = std::get_if<dp::Polygon>(&fc.features[i].geometry);
+        const auto *b = std::get_if<dp::Polygon>(&back.features[i].geometry);
+        if (!a || !b)
+            continue;
+        REQUIRE(a->vertices.size() == b->vertices.size());
+        for (size_t j = 0; j < a->vertices.size(); ++j) {
+            CHECK(std::abs(a->vertices[j].x - b->vertices[j].x) < 0.005);
+            CHECK(std::abs(a->vertices[j].y - b->vertices[j].y) < 0.005);
+        }
+    }
+
+    // Re-writing quantized coordinates gives the same text
+    std::string again;
+    vectkit::write_to_buffer(back, again, options);
+    CHECK(again == quantized);
+
+    std::filesystem::remove(test_file);
+}